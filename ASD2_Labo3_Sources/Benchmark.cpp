@@ -0,0 +1,46 @@
+/*
+ * @file   Benchmark.cpp
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <sys/resource.h>
+
+namespace {
+	// centile p (entre 0 et 1) d'une serie triee non vide
+	double percentile(const std::vector<double>& sorted, double p) {
+		size_t rank = size_t(std::ceil(p * sorted.size()));
+		return sorted[rank == 0 ? 0 : rank - 1];
+	}
+}
+
+Statistics Summarize(std::vector<double> samples)
+{
+	Statistics s = Statistics();
+	s.runs = int(samples.size());
+	if(samples.empty()) return s;
+
+	std::sort(samples.begin(), samples.end());
+	s.min = samples.front();
+	s.max = samples.back();
+	s.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+	size_t n = samples.size();
+	s.median = n % 2 ? samples[n/2] : (samples[n/2 - 1] + samples[n/2]) / 2;
+	s.p95 = percentile(samples, 0.95);
+	s.p99 = percentile(samples, 0.99);
+	return s;
+}
+
+long PeakRSS()
+{
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+	return usage.ru_maxrss;     // kilooctets sous Linux
+}
@@ -0,0 +1,75 @@
+/*
+ * @file   Benchmark.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_Benchmark_h
+#define ASD2_Benchmark_h
+
+#include <vector>
+#include <chrono>
+
+// Outils de mesure des performances. Les temps sont des temps reels
+// (std::chrono::steady_clock) et non du temps CPU comme clock(), qui
+// additionne le temps de tous les threads et ignore les attentes.
+
+class Stopwatch {
+private:
+	std::chrono::steady_clock::time_point start;
+
+public:
+	// Demarre le chronometre
+	Stopwatch() : start(std::chrono::steady_clock::now()) { }
+
+	// Remet le chronometre a zero
+	void Restart() { start = std::chrono::steady_clock::now(); }
+
+	// Temps ecoule depuis le demarrage, en secondes
+	double Seconds() const {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+};
+
+// Resume statistique d'une serie de mesures, en secondes
+struct Statistics {
+	int runs;
+	double min, mean, median, p95, p99, max;
+};
+
+/**
+ * @brief Calcule le resume statistique des mesures samples. Les centiles
+ *        sont calcules par la methode du rang le plus proche.
+ */
+Statistics Summarize(std::vector<double> samples);
+
+/**
+ * @brief Pic de memoire residente du processus (getrusage), en kilooctets.
+ *        Ce maximum ne fait que croitre depuis le demarrage.
+ */
+long PeakRSS();
+
+/**
+ * @brief Mesure le temps d'execution de f
+ * @param warmup, nombre d'executions non mesurees faites avant, pour
+ *        remplir les caches et stabiliser la frequence du processeur
+ * @param repetitions, nombre d'executions mesurees
+ * @return les temps des executions mesurees, en secondes
+ */
+template<typename Func>
+std::vector<double> Measure(Func f, int warmup, int repetitions) {
+	for(int i = 0; i < warmup; ++i)
+		f();
+	std::vector<double> samples;
+	samples.reserve(repetitions);
+	for(int i = 0; i < repetitions; ++i) {
+		Stopwatch watch;
+		f();
+		samples.push_back(watch.Seconds());
+	}
+	return samples;
+}
+
+#endif
@@ -0,0 +1,299 @@
+/*
+ * @file   CSRGraph.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_CSRGraph_h
+#define ASD2_CSRGraph_h
+
+#include <vector>
+#include <memory>
+#include <type_traits>
+
+#include "EdgeWeightedGraph.h"
+#include "EdgeWeightedDiGraph.h"
+
+// Graphes immuables au format CSR (compressed sparse row). Les listes
+// d'adjacence sont mises bout a bout dans deux tableaux contigus targets
+// et weights; les arcs partant du sommet v occupent les positions
+// offsets[v] .. offsets[v+1]-1. Il n'y a donc aucune allocation par arc
+// et le parcours des voisins d'un sommet lit de la memoire contigue.
+//
+// Les classes exposent la meme API que EdgeWeightedDiGraph et
+// EdgeWeightedGraph (V(), forEachVertex, forEachAdjacentEdge,
+// forEachAdjacentVertex, forEachEdge) et peuvent donc etre utilisees
+// telles quelles par ShortestPath et MinimumSpanningTree.
+//
+// Les tableaux sont partages entre les copies d'un meme graphe (le graphe
+// est immuable), et peuvent provenir de n'importe quel proprietaire, par
+// exemple un fichier projete en memoire.
+
+template<typename T> // type des arcs, WeightedDirectedEdge<W> ou WeightedEdge<W>
+class CSRGraphCommon {
+public:
+	// Type des arcs/arêtes.
+	typedef T Edge;
+
+	// Type de donnée pour les poids
+	typedef typename Edge::WeightType WeightType;
+
+	// Tableaux CSR possedes par le graphe
+	struct Storage {
+		std::vector<int> offsets;          // V+1 elements
+		std::vector<int> targets;          // un element par entree d'adjacence
+		std::vector<WeightType> weights;   // idem
+	};
+
+protected:
+	// proprietaire des tableaux, garde ceux-ci en vie
+	std::shared_ptr<const void> owner;
+
+	int nV;
+	const int* offsets;
+	const int* targets;
+	const WeightType* weights;
+
+	CSRGraphCommon() : nV(0), offsets(nullptr), targets(nullptr), weights(nullptr) { }
+
+	// Adopte des tableaux CSR possedes par owner
+	void adopt(std::shared_ptr<const void> _owner, int V,
+	           const int* _offsets, const int* _targets, const WeightType* _weights) {
+		owner = std::move(_owner);
+		nV = V;
+		offsets = _offsets;
+		targets = _targets;
+		weights = _weights;
+	}
+
+	// Adopte les tableaux de storage
+	void adopt(std::shared_ptr<Storage> storage) {
+		const Storage& s = *storage;
+		adopt(storage, int(s.offsets.size()) - 1,
+		      s.offsets.data(), s.targets.data(), s.weights.data());
+	}
+
+public:
+	// Renvoie le nombre de sommets V
+	int V() const { return nV; }
+
+	// Renvoie le nombre d'entrees d'adjacence (E pour un graphe oriente,
+	// 2E moins le nombre de boucles pour un graphe non oriente)
+	int Entries() const { return nV ? offsets[nV] : 0; }
+
+	// Degre sortant du sommet v
+	int Degree(int v) const { return offsets[v+1] - offsets[v]; }
+
+	// Acces direct aux tableaux CSR
+	const int* Offsets() const { return offsets; }
+	const int* Targets() const { return targets; }
+	const WeightType* Weights() const { return weights; }
+
+	// Parcours des arcs/arêtes adjacentes au sommet v.
+	// la fonction f doit prendre un seul argument de type Edge
+	template<typename Func>
+	void forEachAdjacentEdge(int v, Func f) const {
+		for(int i = offsets[v]; i < offsets[v+1]; ++i)
+			f(Edge(v, targets[i], weights[i]));
+	}
+
+	// Parcours de tous les sommets adjacents au sommet v
+	// la fonction f doit prendre un seul argument de type int
+	template<typename Func>
+	void forEachAdjacentVertex(int v, Func f) const {
+		for(int i = offsets[v]; i < offsets[v+1]; ++i)
+			f(targets[i]);
+	}
+
+	// Parcours de tous les sommets du graphe.
+	// la fonction f doit prendre un seul argument de type int
+	template<typename Func>
+	void forEachVertex(Func f) const {
+		for(int v=0;v<V();++v)
+			f(v);
+	}
+
+	/**
+	 * @brief Construit les tableaux CSR a partir d'une liste d'arcs par
+	 *        tri par denombrement (comptage des degres puis remplissage).
+	 *        L'ordre des arcs d'un meme sommet est celui de la liste.
+	 * @param V nombre de sommets
+	 * @param from, to, weight extremites et poids des E arcs
+	 * @param undirected si vrai, chaque arete v-w (v != w) est ajoutee aux
+	 *        listes de v et de w, comme EdgeWeightedGraph::addEdge
+	 */
+	static std::shared_ptr<Storage> BuildStorage(int V,
+	                                             const std::vector<int>& from,
+	                                             const std::vector<int>& to,
+	                                             const std::vector<WeightType>& weight,
+	                                             bool undirected) {
+		auto s = std::make_shared<Storage>();
+		size_t E = from.size();
+
+		s->offsets.assign(V+1, 0);
+		for(size_t i = 0; i < E; ++i) {
+			++s->offsets[from[i]+1];
+			if(undirected && from[i] != to[i]) ++s->offsets[to[i]+1];
+		}
+		for(int v = 0; v < V; ++v)
+			s->offsets[v+1] += s->offsets[v];
+
+		s->targets.resize(s->offsets[V]);
+		s->weights.resize(s->offsets[V]);
+
+		std::vector<int> next(s->offsets.begin(), s->offsets.end()-1);
+		for(size_t i = 0; i < E; ++i) {
+			int p = next[from[i]]++;
+			s->targets[p] = to[i];
+			s->weights[p] = weight[i];
+			if(undirected && from[i] != to[i]) {
+				p = next[to[i]]++;
+				s->targets[p] = from[i];
+				s->weights[p] = weight[i];
+			}
+		}
+		return s;
+	}
+
+protected:
+	// Construit les tableaux CSR a partir de n'importe quel graphe definissant
+	// V() et forEachAdjacentEdge(int,Func). neighbour(v,e) renvoie l'autre
+	// extremite de e vue depuis v, ou -1 si e ne doit pas etre gardee.
+	template<typename GraphType, typename Neighbour>
+	static std::shared_ptr<Storage> buildFrom(const GraphType& g, Neighbour neighbour) {
+		auto s = std::make_shared<Storage>();
+		int V = g.V();
+
+		s->offsets.assign(V+1, 0);
+		for(int v = 0; v < V; ++v)
+			g.forEachAdjacentEdge(v, [&](const typename GraphType::Edge& e) {
+				if(neighbour(v,e) >= 0) ++s->offsets[v+1];
+			});
+		for(int v = 0; v < V; ++v)
+			s->offsets[v+1] += s->offsets[v];
+
+		s->targets.reserve(s->offsets[V]);
+		s->weights.reserve(s->offsets[V]);
+		for(int v = 0; v < V; ++v)
+			g.forEachAdjacentEdge(v, [&](const typename GraphType::Edge& e) {
+				int w = neighbour(v,e);
+				if(w >= 0) {
+					s->targets.push_back(w);
+					s->weights.push_back(e.Weight());
+				}
+			});
+		return s;
+	}
+};
+
+// Graphe pondere oriente au format CSR
+
+template<typename T> // Type du poids, par exemple int ou double
+class CSRDiGraph : public CSRGraphCommon< WeightedDirectedEdge<T> > {
+	// defini la class mere comme BASE.
+	typedef CSRGraphCommon< WeightedDirectedEdge<T> > BASE;
+
+public:
+	// Type des arcs
+	typedef typename BASE::Edge Edge;
+
+	// Type de donnée pour les poids
+	typedef typename BASE::WeightType WeightType;
+
+	// Graphe vide
+	CSRDiGraph() { }
+
+	// Construit le graphe a partir de tableaux CSR
+	explicit CSRDiGraph(std::shared_ptr<typename BASE::Storage> storage) {
+		this->adopt(storage);
+	}
+
+	// Construit le graphe a partir de tableaux CSR possedes par owner
+	CSRDiGraph(std::shared_ptr<const void> owner, int V,
+	           const int* offsets, const int* targets, const WeightType* weights) {
+		this->adopt(owner, V, offsets, targets, weights);
+	}
+
+	// Fige un graphe oriente quelconque (EdgeWeightedDiGraph, TrainDiGraphWrapper, ...)
+	// Seuls les arcs partant de v sont gardes dans la liste de v.
+	template<typename GraphType,
+	         typename = typename std::enable_if<!std::is_base_of<CSRDiGraph,GraphType>::value>::type>
+	explicit CSRDiGraph(const GraphType& g) {
+		this->adopt(BASE::buildFrom(g, [](int v, const typename GraphType::Edge& e) {
+			return e.From() == v ? e.To() : -1;
+		}));
+	}
+
+	// Parcours de tous les arcs du graphe.
+	// la fonction f doit prendre un seul argument de type Edge
+	template<typename Func>
+	void forEachEdge(Func f) const {
+		for(int v=0;v<this->V();++v)
+			this->forEachAdjacentEdge(v, f);
+	}
+};
+
+// Graphe pondere non oriente au format CSR. Chaque arete v-w figure dans les
+// listes de v et de w. Les aretes sont presentees avec Either() == v.
+
+template<typename T> // Type du poids, par exemple int ou double
+class CSRGraph : public CSRGraphCommon< WeightedEdge<T> > {
+	// defini la class mere comme BASE.
+	typedef CSRGraphCommon< WeightedEdge<T> > BASE;
+
+public:
+	// Type des arêtes.
+	typedef typename BASE::Edge Edge;
+
+	// Type de donnée pour les poids
+	typedef typename BASE::WeightType WeightType;
+
+	// Graphe vide
+	CSRGraph() { }
+
+	// Construit le graphe a partir de tableaux CSR
+	explicit CSRGraph(std::shared_ptr<typename BASE::Storage> storage) {
+		this->adopt(storage);
+	}
+
+	// Construit le graphe a partir de tableaux CSR possedes par owner
+	CSRGraph(std::shared_ptr<const void> owner, int V,
+	         const int* offsets, const int* targets, const WeightType* weights) {
+		this->adopt(owner, V, offsets, targets, weights);
+	}
+
+	// Fige un graphe non oriente quelconque (EdgeWeightedGraph, TrainGraphWrapper, ...)
+	template<typename GraphType,
+	         typename = typename std::enable_if<!std::is_base_of<CSRGraph,GraphType>::value>::type>
+	explicit CSRGraph(const GraphType& g) {
+		this->adopt(BASE::buildFrom(g, [](int v, const typename GraphType::Edge& e) {
+			return e.Other(v);
+		}));
+	}
+
+	// Parcours de toutes les arêtes du graphe, chacune une seule fois.
+	// la fonction f doit prendre un seul argument de type Edge
+	template<typename Func>
+	void forEachEdge(Func f) const {
+		for(int v=0;v<this->V();++v)
+			for(int i = this->offsets[v]; i < this->offsets[v+1]; ++i)
+				if(this->targets[i] >= v)
+					f(Edge(v, this->targets[i], this->weights[i]));
+	}
+};
+
+// Fige un EdgeWeightedDiGraph en CSRDiGraph
+template<typename T>
+CSRDiGraph<T> Freeze(const EdgeWeightedDiGraph<T>& g) {
+	return CSRDiGraph<T>(g);
+}
+
+// Fige un EdgeWeightedGraph en CSRGraph
+template<typename T>
+CSRGraph<T> Freeze(const EdgeWeightedGraph<T>& g) {
+	return CSRGraph<T>(g);
+}
+
+#endif
@@ -0,0 +1,398 @@
+/*
+ * @file   ContractionHierarchy.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_ContractionHierarchy_h
+#define ASD2_ContractionHierarchy_h
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "CSRGraph.h"
+#include "IndexMinPQ.h"
+#include "PointToPointSP.h"
+
+// Hierarchie de contraction (Geisberger et al.). Pretraitement: les sommets
+// sont contractes un a un, du moins important au plus important. Contracter
+// v consiste a le retirer du graphe en ajoutant un raccourci u->w de poids
+// w(u,v)+w(v,w) pour chaque paire d'arcs u->v->w, sauf si une recherche
+// locale (recherche de temoin) trouve un chemin u->w au moins aussi court
+// qui evite v. L'ordre de contraction est donne par la difference d'arcs:
+// nombre de raccourcis ajoutes moins nombre d'arcs retires, plus le nombre
+// de voisins deja contractes pour repartir les contractions dans le graphe.
+//
+// Requete: recherche bidirectionnelle ou chaque direction ne suit que des
+// arcs montant vers des sommets contractes plus tard. Les deux recherches
+// se rejoignent au sommet le plus important du plus court chemin. Les
+// raccourcis du chemin trouve sont ensuite deplies en arcs du graphe.
+//
+// Le graphe est suppose statique: il faut reconstruire la hierarchie si
+// les poids changent. Les poids doivent etre positifs ou nuls.
+
+template<typename GraphType> // Type du graphe pondere oriente a traiter
+							 // GraphType doit se comporter comme un
+							 // EdgeWeightedDiGraph et definir V() et
+							 // forEachAdjacentEdge(int,Func), ainsi que le type GraphType::Edge.
+class ContractionHierarchy {
+public:
+	typedef typename GraphType::Edge Edge;
+	typedef typename Edge::WeightType Weight;
+	typedef std::vector<Edge> Edges;
+
+private:
+	// Arc du graphe ou raccourci. Un raccourci remplace les arcs
+	// child1 (from->milieu) et child2 (milieu->to).
+	struct CHEdge {
+		int from, to;
+		Weight weight;
+		int child1, child2;     // -1 pour un arc du graphe
+	};
+
+	int V;
+	std::vector<CHEdge> edges;
+	std::vector<int> rank;          // ordre de contraction des sommets
+
+	// arcs montants: upEdges[upOffsets[v]..] sont les arcs v->w avec rank[w] > rank[v]
+	std::vector<int> upOffsets, upEdges;
+	// arcs descendants vus depuis leur extremite: downEdges[downOffsets[w]..]
+	// sont les arcs u->w avec rank[u] > rank[w]
+	std::vector<int> downOffsets, downEdges;
+
+	// Etat du pretraitement
+	struct Builder {
+		ContractionHierarchy& ch;
+		std::vector<std::vector<int>> out, in;   // arcs sortants/entrants non contractes
+		std::vector<char> contracted;
+		std::vector<int> deletedNeighbours;
+		int maxSettled;
+
+		// recherche de temoin
+		std::vector<Weight> dist;
+		std::vector<int> hops;                   // nombre d'arcs du chemin trouve
+		std::vector<char> target;                // sommets w dont on cherche la distance
+		std::vector<int> touched;
+		IndexMinPQ<Weight> pq;
+
+		// Limite en nombre d'arcs des recherches de temoin. Un temoin est
+		// presque toujours un chemin de quelques arcs: la limiter evite
+		// d'explorer tout le voisinage, au prix de quelques raccourcis
+		// inutiles.
+		static const int maxHops = 5;
+
+		Builder(ContractionHierarchy& _ch, int _maxSettled)
+			: ch(_ch), out(_ch.V), in(_ch.V), contracted(_ch.V, 0), deletedNeighbours(_ch.V, 0),
+			  maxSettled(_maxSettled),
+			  dist(_ch.V, std::numeric_limits<Weight>::max()), hops(_ch.V, 0), target(_ch.V, 0), pq(_ch.V) {
+			for(int e = 0; e < int(ch.edges.size()); ++e) {
+				out[ch.edges[e].from].push_back(e);
+				in[ch.edges[e].to].push_back(e);
+			}
+		}
+
+		// Dijkstra depuis u dans le graphe non contracte prive de v,
+		// limite aux distances <= limit, a maxSettled sommets et aux
+		// chemins d'au plus hopLimit arcs. S'arrete des que les targets
+		// sommets marques dans target sont fixes.
+		void witnessSearch(int u, int v, Weight limit, int maxSettled, int hopLimit, int targets) {
+			for(int x : touched) dist[x] = std::numeric_limits<Weight>::max();
+			touched.clear();
+			pq.Clear();
+
+			dist[u] = 0;
+			hops[u] = 0;
+			touched.push_back(u);
+			pq.Push(u, 0);
+			int settled = 0;
+			while(!pq.Empty() && settled < maxSettled) {
+				if(pq.TopKey() > limit) break;
+				int x = pq.Pop();
+				++settled;
+				if(target[x] && --targets == 0) break;
+				if(hops[x] >= hopLimit) continue;
+				for(int e : out[x]) {
+					int y = ch.edges[e].to;
+					if(y == v) continue;
+					Weight d = dist[x] + ch.edges[e].weight;
+					if(d < dist[y]) {
+						if(dist[y] == std::numeric_limits<Weight>::max()) touched.push_back(y);
+						dist[y] = d;
+						hops[y] = hops[x] + 1;
+						pq.PushOrDecrease(y, d);
+					}
+				}
+			}
+		}
+
+		// Ajoute le raccourci u->w, sauf si un arc u->w au moins aussi court
+		// existe deja. Un arc u->w plus long est remplace dans les listes.
+		void addShortcut(int u, int w, Weight need, int a, int b) {
+			for(int& e : out[u])
+				if(ch.edges[e].to == w) {
+					if(ch.edges[e].weight <= need) return;
+					int old = e;
+					e = int(ch.edges.size());
+					std::replace(in[w].begin(), in[w].end(), old, e);
+					ch.edges.push_back(CHEdge{u, w, need, a, b});
+					return;
+				}
+			int e = int(ch.edges.size());
+			ch.edges.push_back(CHEdge{u, w, need, a, b});
+			out[u].push_back(e);
+			in[w].push_back(e);
+		}
+
+		// Temoins d'un seul arc: la simulation, qui ne sert qu'a estimer la
+		// priorite, se contente des arcs directs u->w, sans queue de priorite
+		void directWitnesses(int u, int v) {
+			for(int x : touched) dist[x] = std::numeric_limits<Weight>::max();
+			touched.clear();
+			for(int e : out[u]) {
+				int y = ch.edges[e].to;
+				if(y == v) continue;
+				if(dist[y] == std::numeric_limits<Weight>::max()) touched.push_back(y);
+				dist[y] = std::min(dist[y], ch.edges[e].weight);
+			}
+		}
+
+		// Contracte v, ou compte seulement les raccourcis necessaires si simulate
+		int contract(int v, bool simulate) {
+			int shortcuts = 0;
+			std::vector<int> inV(in[v]), outV(out[v]);
+			for(int a : inV) {
+				int u = ch.edges[a].from;
+				if(u == v) continue;
+
+				Weight limit = 0;
+				int targets = 0;
+				for(int b : outV) {
+					int w = ch.edges[b].to;
+					if(w == v || w == u) continue;
+					limit = std::max(limit, ch.edges[a].weight + ch.edges[b].weight);
+					if(!target[w]) ++targets;
+					target[w] = 1;
+				}
+				if(targets == 0) continue;
+
+				if(simulate) directWitnesses(u, v);
+				else witnessSearch(u, v, limit, maxSettled, maxHops, targets);
+				for(int b : outV) target[ch.edges[b].to] = 0;
+				for(int b : outV) {
+					int w = ch.edges[b].to;
+					if(w == v || w == u) continue;
+					Weight need = ch.edges[a].weight + ch.edges[b].weight;
+					if(dist[w] <= need) continue;
+					++shortcuts;
+					if(!simulate) addShortcut(u, w, need, a, b);
+				}
+			}
+			return shortcuts;
+		}
+
+		// Difference d'arcs de v. Les listes ne contiennent que des arcs
+		// entre sommets non contractes.
+		int priority(int v) {
+			int removed = int(in[v].size() + out[v].size());
+			return contract(v, true) - removed + deletedNeighbours[v];
+		}
+
+		// Retire v des listes de ses voisins une fois contracte
+		void detach(int v) {
+			for(int e : in[v]) {
+				std::vector<int>& l = out[ch.edges[e].from];
+				l.erase(std::remove_if(l.begin(), l.end(), [&](int f) { return ch.edges[f].to == v; }), l.end());
+			}
+			for(int e : out[v]) {
+				std::vector<int>& l = in[ch.edges[e].to];
+				l.erase(std::remove_if(l.begin(), l.end(), [&](int f) { return ch.edges[f].from == v; }), l.end());
+			}
+		}
+
+		void run() {
+			IndexMinPQ<int> order(ch.V);
+			for(int v = 0; v < ch.V; ++v)
+				order.Push(v, priority(v));
+
+			int next = 0;
+			std::vector<int> neighbours;
+			while(!order.Empty()) {
+				int v = order.Pop();
+				// mise a jour paresseuse: la priorite de v a pu augmenter
+				int p = priority(v);
+				if(!order.Empty() && p > order.TopKey()) {
+					order.Push(v, p);
+					continue;
+				}
+
+				contract(v, false);
+				detach(v);
+				contracted[v] = 1;
+				ch.rank[v] = next++;
+
+				// les voisins de v ont perdu des arcs et gagne des raccourcis:
+				// leur priorite est recalculee tout de suite
+				neighbours.clear();
+				for(int e : in[v]) neighbours.push_back(ch.edges[e].from);
+				for(int e : out[v]) neighbours.push_back(ch.edges[e].to);
+				std::sort(neighbours.begin(), neighbours.end());
+				neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+				for(int u : neighbours) {
+					if(u == v) continue;
+					++deletedNeighbours[u];
+					order.ChangeKey(u, priority(u));
+				}
+				in[v].clear();
+				out[v].clear();
+			}
+		}
+	};
+
+	// Range les arcs selon le sens de la hierarchie
+	void buildSearchGraphs() {
+		upOffsets.assign(V+1, 0);
+		downOffsets.assign(V+1, 0);
+		for(const CHEdge& e : edges) {
+			if(rank[e.to] > rank[e.from]) ++upOffsets[e.from+1];
+			else if(rank[e.from] > rank[e.to]) ++downOffsets[e.to+1];
+		}
+		for(int v = 0; v < V; ++v) {
+			upOffsets[v+1] += upOffsets[v];
+			downOffsets[v+1] += downOffsets[v];
+		}
+		upEdges.resize(upOffsets[V]);
+		downEdges.resize(downOffsets[V]);
+		std::vector<int> nextUp(upOffsets.begin(), upOffsets.end()-1);
+		std::vector<int> nextDown(downOffsets.begin(), downOffsets.end()-1);
+		for(int e = 0; e < int(edges.size()); ++e) {
+			if(rank[edges[e].to] > rank[edges[e].from]) upEdges[nextUp[edges[e].from]++] = e;
+			else if(rank[edges[e].from] > rank[edges[e].to]) downEdges[nextDown[edges[e].to]++] = e;
+		}
+	}
+
+	// Deplie l'arc ou raccourci e en arcs du graphe, ajoutes a path
+	void unpack(int e, Edges& path) const {
+		std::vector<int> stack(1, e);
+		while(!stack.empty()) {
+			const CHEdge& c = edges[stack.back()];
+			stack.pop_back();
+			if(c.child1 < 0) {
+				path.push_back(Edge(c.from, c.to, c.weight));
+			} else {
+				stack.push_back(c.child2);
+				stack.push_back(c.child1);
+			}
+		}
+	}
+
+public:
+	/**
+	 * @brief Constructeur. Calcule la hierarchie de contraction de g.
+	 * @param g, graphe dans lequel on veut faire des recherches
+	 * @param maxSettled, nombre maximal de sommets fixes par recherche de
+	 *        temoin. Une valeur plus faible accelere le pretraitement mais
+	 *        ajoute des raccourcis inutiles. Les recherches de temoins se
+	 *        limitent aussi a maxHops arcs, et le calcul des priorites
+	 *        n'utilise que les arcs directs.
+	 */
+	explicit ContractionHierarchy(const GraphType& g, int maxSettled = 500) : V(g.V()), rank(g.V(), 0) {
+		CSRDiGraph<Weight> csr(g);
+		edges.reserve(csr.Entries());
+		for(int v = 0; v < V; ++v)
+			for(int i = csr.Offsets()[v]; i < csr.Offsets()[v+1]; ++i)
+				if(csr.Targets()[i] != v)
+					edges.push_back(CHEdge{v, csr.Targets()[i], csr.Weights()[i], -1, -1});
+
+		Builder(*this, maxSettled).run();
+		buildSearchGraphs();
+	}
+
+	// Nombre de raccourcis ajoutes par le pretraitement
+	int Shortcuts() const {
+		int n = 0;
+		for(const CHEdge& e : edges) if(e.child1 >= 0) ++n;
+		return n;
+	}
+
+	// Position de v dans l'ordre de contraction
+	int Rank(int v) const { return rank[v]; }
+
+	typedef QueryWorkspace<Weight> Workspace;
+
+	/**
+	 * @brief Recherche un plus court chemin de s a t
+	 * @param s, sommet de depart
+	 * @param t, sommet d'arrivee
+	 * @return le chemin trouve, raccourcis deplies
+	 */
+	Route<Edge> Query(int s, int t) const {
+		Workspace workspace;
+		return Query(s, t, workspace);
+	}
+
+	/**
+	 * @brief Recherche un plus court chemin de s a t en reutilisant workspace
+	 * @param workspace, espace de travail propre au thread appelant
+	 */
+	Route<Edge> Query(int s, int t, Workspace& workspace) const {
+		const Weight INF = std::numeric_limits<Weight>::max();
+		Route<Edge> route;
+
+		// parent: arc par lequel le sommet a ete atteint
+		SearchSpace<Weight>* space[2] = { &workspace.forward, &workspace.backward };
+		const std::vector<int>* offsets[2] = { &upOffsets, &downOffsets };
+		const std::vector<int>* adj[2] = { &upEdges, &downEdges };
+
+		space[0]->Reset(V); space[0]->Set(s, 0, -1); space[0]->Queue().Push(s, 0);
+		space[1]->Reset(V); space[1]->Set(t, 0, -1); space[1]->Queue().Push(t, 0);
+		Weight best = INF;
+		int meet = -1;
+
+		for(int dir = 0; ; dir = 1 - dir) {
+			const IndexMinPQ<Weight>& pq0 = space[0]->Queue();
+			const IndexMinPQ<Weight>& pq1 = space[1]->Queue();
+			bool active0 = !pq0.Empty() && pq0.TopKey() < best;
+			bool active1 = !pq1.Empty() && pq1.TopKey() < best;
+			if(!active0 && !active1) break;
+			if((dir == 0 && !active0) || (dir == 1 && !active1)) continue;
+
+			SearchSpace<Weight>& a = *space[dir];
+			int u = a.Queue().Pop();
+			++route.settled;
+			Weight du = a.Distance(u);
+			Weight other = space[1-dir]->Distance(u);
+			if(other != INF && du + other < best) {
+				best = du + other;
+				meet = u;
+			}
+
+			for(int i = (*offsets[dir])[u]; i < (*offsets[dir])[u+1]; ++i) {
+				int e = (*adj[dir])[i];
+				int w = dir == 0 ? edges[e].to : edges[e].from;
+				Weight d = du + edges[e].weight;
+				if(d < a.Distance(w)) {
+					a.Set(w, d, e);
+					a.Queue().PushOrDecrease(w, d);
+				}
+			}
+		}
+
+		if(meet < 0) return route;
+
+		route.found = true;
+		route.distance = best;
+		std::vector<int> up;
+		for(int v = meet; space[0]->Parent(v) >= 0; v = edges[space[0]->Parent(v)].from)
+			up.push_back(space[0]->Parent(v));
+		for(auto it = up.rbegin(); it != up.rend(); ++it)
+			unpack(*it, route.path);
+		for(int v = meet; space[1]->Parent(v) >= 0; v = edges[space[1]->Parent(v)].to)
+			unpack(space[1]->Parent(v), route.path);
+		return route;
+	}
+};
+
+#endif
@@ -0,0 +1,254 @@
+/*
+ * @file   DynamicMST.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_DynamicMST_h
+#define ASD2_DynamicMST_h
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "CSRGraph.h"
+#include "UnionFind.h"
+
+// Arbre couvrant de poids minimum d'un graphe dont les poids des aretes
+// changent. L'arbre (une foret si le graphe n'est pas connexe) est calcule
+// une fois par Kruskal, puis maintenu a chaque changement de poids:
+//
+// - si une arete hors de l'arbre devient plus legere, elle forme un cycle
+//   avec le chemin de l'arbre entre ses extremites. Elle remplace l'arete la
+//   plus lourde de ce cycle si elle est plus legere qu'elle;
+// - si une arete de l'arbre devient plus lourde, la retirer coupe l'arbre en
+//   deux. On parcourt les aretes qui traversent cette coupe depuis le plus
+//   petit des deux cotes et on garde la plus legere (eventuellement l'arete
+//   modifiee elle-meme).
+//
+// Les autres cas ne changent pas l'arbre. Une mise a jour coute un parcours
+// de l'arbre et des aretes d'un des cotes de la coupe, au lieu d'un Kruskal
+// complet. Les aretes de meme poids sont departagees par leur indice, ce qui
+// rend l'arbre unique.
+
+template<typename GraphType> // Type du graphe pondere non oriente a traiter
+							 // GraphType doit se comporter comme un
+							 // EdgeWeightedGraph et definir V() et forEachEdge(Func),
+							 // ainsi que le type GraphType::Edge.
+class DynamicMST {
+public:
+	typedef typename GraphType::Edge Edge;
+	typedef typename Edge::WeightType Weight;
+	typedef std::vector<Edge> EdgeList;
+
+private:
+	int nV;
+	std::vector<int> ends1, ends2;              // extremites des aretes
+	std::vector<Weight> weights;
+	std::vector<std::vector<int>> adj;          // aretes incidentes a chaque sommet
+	std::vector<std::vector<int>> treeAdj;      // aretes de l'arbre incidentes a chaque sommet
+	std::vector<char> inTree;
+	Weight total;
+
+	// Tableaux de travail des parcours de l'arbre, reutilises d'une mise a
+	// jour a l'autre comme dans SearchSpace: un sommet n'est marque que si
+	// stamp[x] == generation, et parentEdge[x] n'a de sens que pour un
+	// sommet marque. Une mise a jour n'ecrit que les sommets qu'elle visite.
+	std::vector<unsigned> stamp;
+	unsigned generation = 0;
+	std::vector<int> parentEdge;
+	std::vector<int> stack;
+	std::vector<int> side[2];
+
+	// Commence un nouveau parcours: plus aucun sommet n'est marque
+	void newSearch() {
+		if(++generation == 0) {   // debordement: les anciens numeros reviendraient
+			std::fill(stamp.begin(), stamp.end(), 0);
+			generation = 1;
+		}
+	}
+
+	bool marked(int x) const { return stamp[x] == generation; }
+	void mark(int x) { stamp[x] = generation; }
+
+	// ordre strict des aretes: poids puis indice
+	bool lighter(int a, int b) const {
+		return weights[a] < weights[b] || (weights[a] == weights[b] && a < b);
+	}
+
+	int other(int e, int v) const { return ends1[e] == v ? ends2[e] : ends1[e]; }
+
+	void addToTree(int e) {
+		inTree[e] = 1;
+		treeAdj[ends1[e]].push_back(e);
+		treeAdj[ends2[e]].push_back(e);
+		total += weights[e];
+	}
+
+	void removeFromTree(int e) {
+		inTree[e] = 0;
+		for(int v : { ends1[e], ends2[e] }) {
+			std::vector<int>& list = treeAdj[v];
+			list.erase(std::find(list.begin(), list.end(), e));
+		}
+		total -= weights[e];
+	}
+
+	// Arete la plus lourde du chemin de l'arbre entre u et v, -1 si u et v
+	// ne sont pas dans le meme arbre
+	int maxOnPath(int u, int v) {
+		if(u == v) return -1;
+		newSearch();
+		stack.assign(1, u);
+		mark(u);
+		parentEdge[u] = -1;
+		while(!stack.empty() && !marked(v)) {
+			int x = stack.back(); stack.pop_back();
+			for(int e : treeAdj[x]) {
+				int y = other(e, x);
+				if(marked(y)) continue;
+				mark(y);
+				parentEdge[y] = e;
+				stack.push_back(y);
+			}
+		}
+		if(!marked(v)) return -1;
+
+		int best = -1;
+		for(int x = v; x != u; x = other(parentEdge[x], x))
+			if(best < 0 || lighter(best, parentEdge[x]))
+				best = parentEdge[x];
+		return best;
+	}
+
+	// Renvoie s tel que side[s] contienne les sommets du plus petit des deux
+	// arbres contenant u et v. Les deux parcours avancent en alternance, on
+	// s'arrete des que l'un est termine.
+	int smallerSide(int u, int v) {
+		newSearch();
+		side[0].assign(1, u);
+		side[1].assign(1, v);
+		size_t next[2] = { 0, 0 };
+		mark(u);
+		mark(v);
+		for(int s = 0; ; s = 1 - s) {
+			if(next[s] == side[s].size()) return s;
+			int x = side[s][next[s]++];
+			for(int e : treeAdj[x]) {
+				int y = other(e, x);
+				if(!marked(y)) {
+					mark(y);
+					side[s].push_back(y);
+				}
+			}
+		}
+	}
+
+	// Meilleure arete reliant l'arbre de l'extremite de e coupe par le
+	// retrait de e a l'autre arbre
+	int bestReplacement(int e) {
+		const std::vector<int>& nodes = side[smallerSide(ends1[e], ends2[e])];
+		newSearch();                   // les sommets marques sont ceux du cote
+		for(int x : nodes) mark(x);
+
+		int best = e;
+		for(int x : nodes)
+			for(int f : adj[x])
+				if(!marked(other(f, x)) && lighter(f, best))
+					best = f;
+		return best;
+	}
+
+public:
+	/**
+	 * @brief Constructeur. Calcule l'arbre couvrant de poids minimum de g.
+	 *        Les aretes sont numerotees dans l'ordre de g.forEachEdge.
+	 */
+	explicit DynamicMST(const GraphType& g)
+		: nV(g.V()), adj(g.V()), treeAdj(g.V()), total(0), stamp(g.V(), 0), parentEdge(g.V()) {
+		g.forEachEdge([this](const Edge& e) {
+			int v = e.Either(), w = e.Other(v);
+			int id = int(weights.size());
+			ends1.push_back(v);
+			ends2.push_back(w);
+			weights.push_back(e.Weight());
+			adj[v].push_back(id);
+			if(w != v) adj[w].push_back(id);
+		});
+		inTree.assign(weights.size(), 0);
+
+		std::vector<int> order(weights.size());
+		for(int e = 0; e < int(order.size()); ++e) order[e] = e;
+		std::sort(order.begin(), order.end(), [this](int a, int b) { return lighter(a, b); });
+
+		std::vector<std::pair<int,int>> pairs;
+		pairs.reserve(order.size());
+		for(int e : order)
+			pairs.push_back(std::make_pair(ends1[e], ends2[e]));
+		CompactUnionFind uf(nV);
+		for(int k : uf.UnionAll(pairs))
+			addToTree(order[k]);
+	}
+
+	// Nombre d'aretes du graphe
+	int E() const { return int(weights.size()); }
+
+	// Arete d'indice e, avec son poids courant
+	Edge EdgeAt(int e) const { return Edge(ends1[e], ends2[e], weights[e]); }
+
+	// Indique si l'arete e fait partie de l'arbre
+	bool InTree(int e) const { return inTree[e]; }
+
+	// Poids total de l'arbre
+	Weight TotalWeight() const { return total; }
+
+	// Aretes de l'arbre
+	EdgeList Tree() const {
+		EdgeList output;
+		for(int e = 0; e < E(); ++e)
+			if(inTree[e]) output.push_back(EdgeAt(e));
+		return output;
+	}
+
+	/**
+	 * @brief Change le poids de l'arete e et met l'arbre a jour
+	 * @param e, indice de l'arete
+	 * @param weight, nouveau poids
+	 */
+	void SetWeight(int e, Weight weight) {
+		Weight old = weights[e];
+		if(inTree[e]) {
+			total += weight - old;
+			weights[e] = weight;
+			if(weight > old) {
+				int f = bestReplacement(e);
+				if(f != e) {
+					removeFromTree(e);
+					addToTree(f);
+				}
+			}
+		} else {
+			weights[e] = weight;
+			if(weight < old) {
+				int f = maxOnPath(ends1[e], ends2[e]);
+				if(f < 0 && ends1[e] != ends2[e])
+					addToTree(e);           // relie deux arbres de la foret
+				else if(f >= 0 && lighter(e, f)) {
+					removeFromTree(f);
+					addToTree(e);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Graphe courant, avec les poids modifies
+	 */
+	CSRGraph<Weight> Graph() const {
+		return CSRGraph<Weight>(CSRGraph<Weight>::BuildStorage(nV, ends1, ends2, weights, true));
+	}
+};
+
+#endif
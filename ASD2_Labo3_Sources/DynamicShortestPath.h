@@ -0,0 +1,263 @@
+/*
+ * @file   DynamicShortestPath.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_DynamicShortestPath_h
+#define ASD2_DynamicShortestPath_h
+
+#include <vector>
+#include <limits>
+
+#include "ShortestPath.h"
+#include "CSRGraph.h"
+#include "IndexMinPQ.h"
+
+// Plus courts chemins depuis une source dans un graphe dont les poids
+// changent (mise a jour incrementale dans l'esprit de Ramalingam et Reps).
+// On garde l'arbre des plus courts chemins et on ne repare que ce qui est
+// touche par un lot de modifications:
+//
+// - un arc de l'arbre dont le poids augmente (ou dont une extremite est
+//   bloquee) invalide le sous-arbre qui en depend. Ses sommets repartent
+//   d'une distance infinie, puis chacun recoit la meilleure distance offerte
+//   par ses arcs entrants venant de sommets hors du sous-arbre;
+// - un arc dont le poids diminue (ou dont une extremite est debloquee) est
+//   relache directement.
+//
+// Les sommets ainsi modifies sont places dans une queue de priorite et
+// l'algorithme de Dijkstra propage les changements a partir d'eux. Les
+// sommets dont la distance ne change pas ne sont pas visites. Les poids
+// doivent etre positifs ou nuls.
+
+template<typename GraphType> // Type du graphe pondere oriente a traiter
+							 // GraphType doit se comporter comme un
+							 // EdgeWeightedDiGraph et definir V() et
+							 // forEachAdjacentEdge(int,Func), ainsi que le type GraphType::Edge.
+class DynamicSP : public ShortestPath<GraphType> {
+public:
+	typedef ShortestPath<GraphType> BASE;
+	typedef typename BASE::Edge Edge;
+	typedef typename BASE::Weight Weight;
+
+	// Une modification du graphe
+	struct Change {
+		enum Type { SetWeight, Block, Unblock };
+		Type type;
+		int v;          // origine de l'arc, ou sommet a (de)bloquer
+		int w;          // extremite de l'arc (SetWeight seulement)
+		Weight weight;  // nouveau poids (SetWeight seulement)
+	};
+
+private:
+	int source;
+
+	// arcs sortants au format CSR, poids modifiables
+	std::vector<int> offsets, targets, sources;
+	std::vector<Weight> weights;
+	// arcs entrants: inArcs[inOffsets[w]..] sont les indices des arcs u->w
+	std::vector<int> inOffsets, inArcs;
+
+	std::vector<char> blocked;
+	std::vector<int> parentArc;     // arc de l'arbre menant au sommet, -1 sinon
+	IndexMinPQ<Weight> pq;
+	int settled;
+
+	// Poids de l'arc i en tenant compte des sommets bloques
+	Weight weightOf(int i) const {
+		if(blocked[sources[i]] || blocked[targets[i]])
+			return std::numeric_limits<Weight>::max();
+		return weights[i];
+	}
+
+	// Fait de l'arc i le dernier arc du chemin vers son extremite
+	void setParent(int w, int i, Weight d) {
+		this->distanceTo[w] = d;
+		parentArc[w] = i;
+		this->edgeTo[w] = Edge(sources[i], w, weights[i]);
+		pq.PushOrDecrease(w, d);
+	}
+
+	// Relache l'arc i
+	void relax(int i) {
+		const Weight INF = std::numeric_limits<Weight>::max();
+		int u = sources[i], w = targets[i];
+		Weight wi = weightOf(i);
+		if(this->distanceTo[u] == INF || wi == INF) return;
+		Weight d = this->distanceTo[u] + wi;
+		if(d < this->distanceTo[w])
+			setParent(w, i, d);
+	}
+
+	// Propage les distances depuis les sommets de la queue
+	void propagate() {
+		while(!pq.Empty()) {
+			int u = pq.Pop();
+			++settled;
+			for(int i = offsets[u]; i < offsets[u+1]; ++i)
+				relax(i);
+		}
+	}
+
+	// Invalide les sous-arbres des extremites des arcs de increased qui
+	// sont dans l'arbre, puis leur donne la distance offerte par leurs arcs
+	// entrants venant de sommets valides.
+	void invalidate(const std::vector<int>& increased) {
+		const Weight INF = std::numeric_limits<Weight>::max();
+		std::vector<int> affected;
+		for(int i : increased) {
+			int root = targets[i];
+			if(parentArc[root] != i) continue;
+			parentArc[root] = -1;
+			this->distanceTo[root] = INF;
+			affected.push_back(root);
+			// parcours du sous-arbre: les fils de u sont les extremites des
+			// arcs sortants de u qui sont leur arc parent
+			for(size_t k = affected.size() - 1; k < affected.size(); ++k) {
+				int u = affected[k];
+				for(int j = offsets[u]; j < offsets[u+1]; ++j)
+					if(parentArc[targets[j]] == j) {
+						parentArc[targets[j]] = -1;
+						this->distanceTo[targets[j]] = INF;
+						affected.push_back(targets[j]);
+					}
+			}
+		}
+
+		for(int x : affected)
+			for(int k = inOffsets[x]; k < inOffsets[x+1]; ++k)
+				relax(inArcs[k]);
+	}
+
+	// Indices des arcs v->w
+	template<typename Func>
+	void forEachArc(int v, int w, Func f) const {
+		for(int i = offsets[v]; i < offsets[v+1]; ++i)
+			if(targets[i] == w) f(i);
+	}
+
+public:
+	/**
+	 * @brief Constructeur a partir du graphe g et du sommet v a la source des plus courts chemins
+	 * @param g, graphe dont on copie les arcs et leurs poids
+	 * @param v, sommet é partir duquel on veut construire
+	 */
+	DynamicSP(const GraphType& g, int v) : source(v), pq(g.V()), settled(0) {
+		CSRDiGraph<Weight> csr(g);
+		int V = csr.V();
+		offsets.assign(csr.Offsets(), csr.Offsets() + V + 1);
+		targets.assign(csr.Targets(), csr.Targets() + csr.Entries());
+		weights.assign(csr.Weights(), csr.Weights() + csr.Entries());
+		sources.resize(csr.Entries());
+		for(int u = 0; u < V; ++u)
+			for(int i = offsets[u]; i < offsets[u+1]; ++i)
+				sources[i] = u;
+
+		inOffsets.assign(V+1, 0);
+		for(int w : targets) ++inOffsets[w+1];
+		for(int w = 0; w < V; ++w)
+			inOffsets[w+1] += inOffsets[w];
+		inArcs.resize(targets.size());
+		std::vector<int> next(inOffsets.begin(), inOffsets.end()-1);
+		for(int i = 0; i < int(targets.size()); ++i)
+			inArcs[next[targets[i]]++] = i;
+
+		blocked.assign(V, 0);
+		parentArc.assign(V, -1);
+		this->edgeTo.resize(V);
+		this->distanceTo.assign(V, std::numeric_limits<Weight>::max());
+		this->edgeTo[v] = Edge(v,v,0);
+		this->distanceTo[v] = 0;
+		pq.Push(v, 0);
+		propagate();
+	}
+
+	// Sommet a la source des plus courts chemins
+	int Source() const { return source; }
+
+	// Indique si le sommet v est bloque
+	bool IsBlocked(int v) const { return blocked[v]; }
+
+	// Nombre de sommets traites lors de la derniere mise a jour
+	int Settled() const { return settled; }
+
+	/**
+	 * @brief Change le poids de tous les arcs v->w
+	 * @param weight, nouveau poids. numeric_limits<Weight>::max() ferme l'arc.
+	 */
+	void SetWeight(int v, int w, Weight weight) {
+		ApplyBatch(std::vector<Change>(1, Change{Change::SetWeight, v, w, weight}));
+	}
+
+	/**
+	 * @brief Bloque le sommet v: aucun chemin ne peut plus y passer
+	 */
+	void Block(int v) {
+		ApplyBatch(std::vector<Change>(1, Change{Change::Block, v, -1, 0}));
+	}
+
+	/**
+	 * @brief Debloque le sommet v
+	 */
+	void Unblock(int v) {
+		ApplyBatch(std::vector<Change>(1, Change{Change::Unblock, v, -1, 0}));
+	}
+
+	/**
+	 * @brief Applique un lot de modifications puis repare les plus courts
+	 *        chemins une seule fois pour tout le lot
+	 * @param changes, modifications a appliquer dans l'ordre
+	 */
+	void ApplyBatch(const std::vector<Change>& changes) {
+		std::vector<int> increased, decreased;
+		for(const Change& c : changes) {
+			switch(c.type) {
+			case Change::SetWeight:
+				forEachArc(c.v, c.w, [&](int i) {
+					if(c.weight > weights[i]) increased.push_back(i);
+					else if(c.weight < weights[i]) decreased.push_back(i);
+					weights[i] = c.weight;
+				});
+				break;
+			case Change::Block:
+			case Change::Unblock: {
+				bool block = c.type == Change::Block;
+				if(bool(blocked[c.v]) == block) break;
+				blocked[c.v] = block;
+				std::vector<int>& list = block ? increased : decreased;
+				for(int k = inOffsets[c.v]; k < inOffsets[c.v+1]; ++k)
+					list.push_back(inArcs[k]);
+				for(int i = offsets[c.v]; i < offsets[c.v+1]; ++i)
+					list.push_back(i);
+				break;
+			}
+			}
+		}
+
+		settled = 0;
+		invalidate(increased);
+		for(int i : decreased)
+			relax(i);
+		propagate();
+	}
+
+	/**
+	 * @brief Graphe courant, sans les arcs fermes ni ceux des sommets bloques
+	 */
+	CSRDiGraph<Weight> Graph() const {
+		std::vector<int> from, to;
+		std::vector<Weight> weight;
+		for(int i = 0; i < int(targets.size()); ++i)
+			if(weightOf(i) != std::numeric_limits<Weight>::max()) {
+				from.push_back(sources[i]);
+				to.push_back(targets[i]);
+				weight.push_back(weights[i]);
+			}
+		return CSRDiGraph<Weight>(CSRDiGraph<Weight>::BuildStorage(int(offsets.size()) - 1, from, to, weight, false));
+	}
+};
+
+#endif
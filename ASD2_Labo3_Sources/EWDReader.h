@@ -0,0 +1,217 @@
+/*
+ * @file   EWDReader.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_EWDReader_h
+#define ASD2_EWDReader_h
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <charconv>
+#include <stdexcept>
+#include <exception>
+
+#include "MappedFile.h"
+#include "CSRGraph.h"
+
+// Lecture rapide des fichiers au format EWD (tinyEWD.txt, 10000EWD.txt, ...):
+//
+//   V
+//   E
+//   v w poids     (E lignes)
+//
+// Le fichier est projete en memoire (MappedFile) et les nombres sont lus avec
+// std::from_chars, sans passer par std::istream ni allouer par arc. Le graphe
+// produit est un CSRDiGraph ou un CSRGraph.
+//
+// La lecture se fait en deux passes: on compte d'abord les lignes de chaque
+// tranche du fichier, puis chaque tranche ecrit ses arcs a sa position dans
+// des tableaux alloues une fois pour toutes. Les tranches peuvent etre
+// traitees en parallele (nbThreads > 1) pour les gros fichiers.
+
+namespace EWDReader {
+
+	// Liste d'arcs sous forme de tableaux paralleles
+	template<typename T>
+	struct EdgeArrays {
+		int V = 0;
+		std::vector<int> from;
+		std::vector<int> to;
+		std::vector<T> weight;
+	};
+
+	namespace detail {
+
+		inline bool isSpace(char c) {
+			return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+		}
+
+		// Lit le prochain nombre a partir de p, en sautant les blancs.
+		template<typename N>
+		const char* parse(const char* p, const char* end, N& value) {
+			while(p < end && isSpace(*p)) ++p;
+			auto res = std::from_chars(p, end, value);
+			if(res.ec != std::errc())
+				throw std::runtime_error("EWDReader: nombre invalide");
+			return res.ptr;
+		}
+
+		// Blanc qui ne termine pas la ligne
+		inline bool isBlank(char c) {
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		// Lit le prochain nombre de la ligne courante, en sautant les blancs
+		// mais pas la fin de ligne: une ligne trop courte est refusee.
+		template<typename N>
+		const char* parseInLine(const char* p, const char* end, N& value) {
+			while(p < end && isBlank(*p)) ++p;
+			if(p == end || *p == '\n')
+				throw std::runtime_error("EWDReader: ligne mal formee");
+			return parse(p, end, value);
+		}
+
+		// Nombre de lignes non vides dans [p,end)
+		inline int countLines(const char* p, const char* end) {
+			int n = 0;
+			bool blank = true;
+			for(; p < end; ++p) {
+				if(*p == '\n') {
+					if(!blank) ++n;
+					blank = true;
+				} else if(!isSpace(*p))
+					blank = false;
+			}
+			return blank ? n : n + 1;
+		}
+
+		// Lit les arcs de la tranche [p,end) aux indices [i,last). Chaque
+		// ligne non vide doit contenir exactement 3 nombres: les nombres ne
+		// sont pas lus comme un flot continu, ce qui accepterait des arcs a
+		// cheval sur deux lignes.
+		template<typename T>
+		void parseEdges(const char* p, const char* end, EdgeArrays<T>& out, int i, int last) {
+			for(;;) {
+				while(p < end && isSpace(*p)) ++p;
+				if(p == end) break;
+				if(i >= last)
+					throw std::runtime_error("EWDReader: ligne mal formee");
+				p = parse(p, end, out.from[i]);
+				p = parseInLine(p, end, out.to[i]);
+				p = parseInLine(p, end, out.weight[i]);
+				while(p < end && isBlank(*p)) ++p;
+				if(p < end && *p != '\n')
+					throw std::runtime_error("EWDReader: ligne mal formee");
+				if(out.from[i] < 0 || out.from[i] >= out.V || out.to[i] < 0 || out.to[i] >= out.V)
+					throw std::runtime_error("EWDReader: sommet hors limites");
+				++i;
+			}
+		}
+	}
+
+	/**
+	 * @brief Lit la liste d'arcs d'un texte au format EWD.
+	 * @param data, size contenu du fichier
+	 * @param nbThreads nombre de tranches lues en parallele
+	 * @throw std::runtime_error si le contenu est mal forme
+	 */
+	template<typename T>
+	EdgeArrays<T> ParseEdges(const char* data, size_t size, unsigned nbThreads = 1) {
+		const char* end = data + size;
+		EdgeArrays<T> out;
+		int E;
+
+		const char* p = detail::parse(data, end, out.V);
+		p = detail::parse(p, end, E);
+		if(out.V < 0 || E < 0)
+			throw std::runtime_error("EWDReader: nombre de sommets ou d'arcs negatif");
+		while(p < end && *p != '\n') ++p;   // fin de la ligne de E
+
+		// decoupe du reste du fichier en tranches se terminant par une fin de ligne
+		if(nbThreads < 1) nbThreads = 1;
+		std::vector<const char*> bounds(1, p);
+		size_t chunk = size_t(end - p) / nbThreads + 1;
+		for(unsigned t = 1; t < nbThreads; ++t) {
+			const char* q = bounds.back() + chunk;
+			if(q >= end) break;
+			while(q < end && *q != '\n') ++q;
+			bounds.push_back(q);
+		}
+		bounds.push_back(end);
+		size_t nbChunks = bounds.size() - 1;
+
+		auto forEachChunk = [&](auto f) {
+			if(nbChunks == 1) { f(0); return; }
+			std::vector<std::thread> threads;
+			for(size_t c = 0; c < nbChunks; ++c)
+				threads.emplace_back(f, c);
+			for(std::thread& th : threads)
+				th.join();
+		};
+
+		// premiere passe: nombre d'arcs par tranche
+		std::vector<int> start(nbChunks + 1, 0);
+		forEachChunk([&](size_t c) {
+			start[c+1] = detail::countLines(bounds[c], bounds[c+1]);
+		});
+		for(size_t c = 0; c < nbChunks; ++c)
+			start[c+1] += start[c];
+		if(start[nbChunks] != E)
+			throw std::runtime_error("EWDReader: nombre d'arcs incoherent");
+
+		// deuxieme passe: remplissage des tableaux
+		out.from.resize(E);
+		out.to.resize(E);
+		out.weight.resize(E);
+		std::vector<std::exception_ptr> errors(nbChunks);
+		forEachChunk([&](size_t c) {
+			try {
+				detail::parseEdges(bounds[c], bounds[c+1], out, start[c], start[c+1]);
+			} catch(...) {
+				errors[c] = std::current_exception();
+			}
+		});
+		for(auto& e : errors)
+			if(e) std::rethrow_exception(e);
+
+		return out;
+	}
+
+	/**
+	 * @brief Lit la liste d'arcs du fichier filename (projete en memoire)
+	 */
+	template<typename T>
+	EdgeArrays<T> ReadEdges(const std::string& filename, unsigned nbThreads = 1) {
+		MappedFile file(filename);
+		return ParseEdges<T>(file.Data(), file.Size(), nbThreads);
+	}
+
+	/**
+	 * @brief Lit un graphe oriente au format EWD
+	 * @param filename nom du fichier
+	 * @param nbThreads nombre de threads de lecture
+	 */
+	template<typename T>
+	CSRDiGraph<T> ReadDiGraph(const std::string& filename, unsigned nbThreads = 1) {
+		EdgeArrays<T> a = ReadEdges<T>(filename, nbThreads);
+		return CSRDiGraph<T>(CSRDiGraph<T>::BuildStorage(a.V, a.from, a.to, a.weight, false));
+	}
+
+	/**
+	 * @brief Lit un graphe non oriente au format EWD
+	 * @param filename nom du fichier
+	 * @param nbThreads nombre de threads de lecture
+	 */
+	template<typename T>
+	CSRGraph<T> ReadGraph(const std::string& filename, unsigned nbThreads = 1) {
+		EdgeArrays<T> a = ReadEdges<T>(filename, nbThreads);
+		return CSRGraph<T>(CSRGraph<T>::BuildStorage(a.V, a.from, a.to, a.weight, true));
+	}
+}
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ * @file   GraphAnalysis.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_GraphAnalysis_h
+#define ASD2_GraphAnalysis_h
+
+#include <vector>
+#include <utility>
+#include <map>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <limits>
+
+#include "TrainGraphWrapper.h"
+
+// Analyse de la connexite d'un graphe non oriente en temps lineaire:
+// composantes connexes, points d'articulation (sommets dont le retrait
+// deconnecte leur composante) et ponts (aretes dont le retrait deconnecte
+// leur composante).
+//
+// Un seul parcours en profondeur suffit (algorithme de Tarjan): on numerote
+// les sommets dans l'ordre de decouverte et on calcule pour chacun low, le
+// plus petit numero atteignable depuis son sous-arbre par une arete de
+// retour. Un fils w de v avec low[w] >= num[v] rend v point d'articulation
+// (sauf la racine, qui l'est si elle a plusieurs fils), low[w] > num[v]
+// fait de v-w un pont. Le parcours est iteratif avec une pile explicite: la
+// profondeur du graphe n'est pas limitee par celle de la pile d'appels.
+//
+// Les resultats sont calcules dans le constructeur. Connected repond ensuite
+// en O(1), ce qui permet de rejeter une recherche de chemin entre deux
+// composantes sans lancer Dijkstra.
+
+template<typename GraphType> // Type du graphe non oriente a analyser
+							 // GraphType doit definir V() et forEachAdjacentVertex(int,Func),
+							 // chaque arete v-w etant vue depuis v et depuis w
+							 // (EdgeWeightedGraph, TrainGraphWrapper, CSRGraph, ...).
+class GraphAnalysis {
+public:
+	typedef std::pair<int,int> Bridge;
+
+private:
+	std::vector<int> component;
+	std::vector<int> componentSize;
+	std::vector<char> articulation;
+	std::vector<int> articulationPoints;
+	std::vector<Bridge> bridges;
+
+	// etat du parcours pour un sommet de la pile
+	struct Frame {
+		int v;
+		int parent;
+		int next;            // prochain voisin a examiner
+		bool parentSkipped;  // l'arete vers le parent a ete ignoree une fois
+	};
+
+public:
+	/**
+	 * @brief Constructeur. Analyse le graphe g.
+	 */
+	explicit GraphAnalysis(const GraphType& g) {
+		int V = g.V();
+
+		// listes d'adjacence au format CSR, pour pouvoir reprendre le
+		// parcours des voisins d'un sommet
+		std::vector<int> offsets(V+1, 0), targets;
+		for(int v = 0; v < V; ++v) {
+			g.forEachAdjacentVertex(v, [&](int w) { targets.push_back(w); });
+			offsets[v+1] = int(targets.size());
+		}
+
+		component.assign(V, -1);
+		articulation.assign(V, 0);
+		std::vector<int> num(V, -1), low(V);
+		std::vector<Frame> stack;
+		int counter = 0;
+
+		for(int root = 0; root < V; ++root) {
+			if(num[root] >= 0) continue;
+			int c = int(componentSize.size());
+			componentSize.push_back(1);
+			component[root] = c;
+			num[root] = low[root] = counter++;
+			stack.push_back(Frame{root, -1, offsets[root], false});
+			int rootChildren = 0;
+
+			while(!stack.empty()) {
+				Frame& f = stack.back();
+				int v = f.v;
+				if(f.next < offsets[v+1]) {
+					int w = targets[f.next++];
+					// une seule des aretes vers le parent est l'arete de l'arbre,
+					// les aretes paralleles sont des aretes de retour
+					if(w == f.parent && !f.parentSkipped) {
+						f.parentSkipped = true;
+						continue;
+					}
+					if(num[w] < 0) {
+						num[w] = low[w] = counter++;
+						component[w] = c;
+						++componentSize[c];
+						if(v == root) ++rootChildren;
+						stack.push_back(Frame{w, v, offsets[w], false});   // f invalide apres push_back
+					} else if(num[w] < low[v])
+						low[v] = num[w];
+				} else {
+					stack.pop_back();
+					if(stack.empty()) break;
+					int u = stack.back().v;
+					if(low[v] < low[u]) low[u] = low[v];
+					if(u != root && low[v] >= num[u]) articulation[u] = 1;
+					if(low[v] > num[u]) bridges.push_back(Bridge(u, v));
+				}
+			}
+			if(rootChildren > 1) articulation[root] = 1;
+		}
+
+		for(int v = 0; v < V; ++v)
+			if(articulation[v]) articulationPoints.push_back(v);
+	}
+
+	// Nombre de composantes connexes
+	int Count() const { return int(componentSize.size()); }
+
+	// Numero de la composante connexe de v, entre 0 et Count()-1
+	int Component(int v) const { return component[v]; }
+
+	// Nombre de sommets de la composante connexe c
+	int ComponentSize(int c) const { return componentSize[c]; }
+
+	// Indique si v et w sont dans la meme composante connexe
+	bool Connected(int v, int w) const { return component[v] == component[w]; }
+
+	// Indique si le retrait de v deconnecte sa composante
+	bool IsArticulationPoint(int v) const { return articulation[v]; }
+
+	// Points d'articulation, par ordre croissant
+	const std::vector<int>& ArticulationPoints() const { return articulationPoints; }
+
+	// Ponts, sous forme de paires (parent, fils) dans l'arbre du parcours
+	const std::vector<Bridge>& Bridges() const { return bridges; }
+};
+
+// Analyses du reseau de trains, gardees en memoire pour chaque fonction de
+// poids. Les lignes fermees (de poids numeric_limits<int>::max()) sont
+// ignorees, les autres comptent pour la connexite quel que soit leur poids.
+// Comme les fonctions ne sont pas comparables,
+// chaque fonction est identifiee par un nom choisi par l'appelant.
+
+class TrainNetworkAnalysis {
+public:
+	typedef GraphAnalysis<CachedTrainGraphWrapper> Analysis;
+
+private:
+	const TrainNetwork& tn;
+	std::map<std::string, std::unique_ptr<Analysis>> cache;
+
+public:
+	/**
+	 * @brief Constructeur
+	 * @param tn, reseau de trains et de lignes
+	 */
+	explicit TrainNetworkAnalysis(const TrainNetwork& _tn) : tn(_tn) { }
+
+	/**
+	 * @brief Analyse du reseau pour la fonction de poids nommee name,
+	 *        calculee au premier appel avec fnWeight
+	 */
+	template<typename FnWeight>
+	const Analysis& Get(const std::string& name, FnWeight fnWeight) {
+		std::unique_ptr<Analysis>& a = cache[name];
+		if(!a)
+			a.reset(new Analysis(CachedTrainGraphWrapper(tn, fnWeight)));
+		return *a;
+	}
+
+	/**
+	 * @brief Indique si s et t restent relies quand la gare closed est
+	 *        fermee (toutes ses lignes ont un poids infini). La reponse est
+	 *        en O(1) si closed n'est pas un point d'articulation du reseau
+	 *        de la fonction name: fermer closed ne coupe alors aucune
+	 *        composante. Sinon, l'analyse du reseau prive de closed est
+	 *        calculee une fois puis gardee sous le nom "name/closed".
+	 */
+	template<typename FnWeight>
+	bool ConnectedWithout(const std::string& name, FnWeight fnWeight, int s, int t, int closed) {
+		if(s == closed || t == closed) return false;
+		const Analysis& base = Get(name, fnWeight);
+		if(!base.Connected(s, t)) return false;
+		if(!base.IsArticulationPoint(closed)) return true;
+		const Analysis& without = Get(name + "/" + std::to_string(closed), [&](const TrainNetwork::Line& l) {
+			if(l.cities.first == closed || l.cities.second == closed) return std::numeric_limits<int>::max();
+			return fnWeight(l);
+		});
+		return without.Connected(s, t);
+	}
+
+	// Indique si l'analyse de la fonction name est deja calculee
+	bool Contains(const std::string& name) const { return cache.count(name) > 0; }
+
+	// Oublie l'analyse de la fonction name, par exemple si elle a change,
+	// ainsi que celles calculees par ConnectedWithout a partir d'elle
+	void Invalidate(const std::string& name) {
+		cache.erase(name);
+		cache.erase(cache.lower_bound(name + "/"), cache.lower_bound(name + "0"));
+	}
+};
+
+#endif
@@ -0,0 +1,447 @@
+/*
+ * @file   GraphGenerator.cpp
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#include "GraphGenerator.h"
+#include "UnionFind.h"
+
+#include <cmath>
+#include <algorithm>
+#include <utility>
+#include <fstream>
+#include <charconv>
+#include <stdexcept>
+#include <limits>
+
+namespace GraphGenerator {
+
+	namespace {
+		// taille des blocs de travail, independante du nombre de threads
+		const int BlockSize = 1 << 16;
+
+		// flux de nombres aleatoires distincts tires d'une meme graine
+		enum Stream { WeightStream, PointStream, DegreeStream, ArcStream };
+
+		// melange splitmix64
+		uint64_t mix(uint64_t x) {
+			x += 0x9E3779B97F4A7C15ULL;
+			x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+			return x ^ (x >> 31);
+		}
+
+		// Generateur splitmix64: un etat de 64 bits, bien plus rapide que
+		// std::mt19937_64 et de qualite suffisante pour generer des graphes
+		struct Random {
+			uint64_t state;
+			uint64_t operator()() { return mix(state++ * 0x9E3779B97F4A7C15ULL); }
+		};
+
+		// generateur du bloc block du flux stream
+		Random blockRng(uint64_t seed, Stream stream, uint64_t block) {
+			return Random{ mix(mix(seed ^ mix(uint64_t(stream))) + block) };
+		}
+
+		// reel uniforme dans [0,1[
+		double uniform(Random& rng) {
+			return double(rng() >> 11) * (1.0 / 9007199254740992.0);
+		}
+
+		int blockCount(size_t n) { return int((n + BlockSize - 1) / BlockSize); }
+
+		// appelle f(b, debut, fin) pour chaque bloc de [0,n), en parallele
+		template<typename Func>
+		void forEachBlock(size_t n, ThreadPool& pool, Func f) {
+			pool.ParallelTasks(blockCount(n), [&](int b) {
+				size_t begin = size_t(b) * BlockSize;
+				f(b, begin, std::min(n, begin + BlockSize));
+			});
+		}
+
+		void resize(Edges& a, size_t E) {
+			if(E > size_t(std::numeric_limits<int>::max()))
+				throw std::invalid_argument("GraphGenerator: trop d'aretes");
+			a.from.resize(E);
+			a.to.resize(E);
+			a.weight.resize(E);
+		}
+
+		// Points uniformes du carre unite, ranges par cellule d'une grille de
+		// side x side cellules: les points de la cellule c sont
+		// order[start[c]..start[c+1]-1].
+		struct Points {
+			std::vector<double> x, y;
+			int side;
+			std::vector<int> start, order;
+
+			Points(int V, int _side, uint64_t seed, ThreadPool& pool) : x(V), y(V), side(_side) {
+				forEachBlock(size_t(V), pool, [&](int b, size_t begin, size_t end) {
+					Random rng = blockRng(seed, PointStream, b);
+					for(size_t v = begin; v < end; ++v) {
+						x[v] = uniform(rng);
+						y[v] = uniform(rng);
+					}
+				});
+				start.assign(size_t(side) * side + 1, 0);
+				for(int v = 0; v < V; ++v) ++start[cell(v) + 1];
+				for(size_t c = 0; c + 1 < start.size(); ++c) start[c+1] += start[c];
+				order.resize(V);
+				std::vector<int> next(start.begin(), start.end() - 1);
+				for(int v = 0; v < V; ++v) order[next[cell(v)]++] = v;
+			}
+
+			int coord(double t) const { return std::min(side - 1, int(t * side)); }
+			int cell(int v) const { return coord(y[v]) * side + coord(x[v]); }
+
+			double squaredDistance(int v, int w) const {
+				double dx = x[v] - x[w], dy = y[v] - y[w];
+				return dx * dx + dy * dy;
+			}
+
+			double distance(int v, int w) const { return std::sqrt(squaredDistance(v, w)); }
+
+			// appelle f(w) pour chaque point des cellules a distance de Chebyshev
+			// exactement ring de la cellule de v
+			template<typename Func>
+			void forEachInRing(int v, int ring, Func f) const {
+				int cx = coord(x[v]), cy = coord(y[v]);
+				for(int gy = cy - ring; gy <= cy + ring; ++gy) {
+					if(gy < 0 || gy >= side) continue;
+					bool edge = gy == cy - ring || gy == cy + ring;
+					for(int gx = cx - ring; gx <= cx + ring; gx += (edge || ring == 0) ? 1 : 2 * ring) {
+						if(gx < 0 || gx >= side) continue;
+						int c = gy * side + gx;
+						for(int k = start[c]; k < start[c+1]; ++k) f(order[k]);
+					}
+				}
+			}
+		};
+	}
+
+	Edges Grid(int rows, int cols, double perturbation, uint64_t seed, ThreadPool& pool) {
+		if(rows < 1 || cols < 1 || long(rows) * cols > std::numeric_limits<int>::max())
+			throw std::invalid_argument("GraphGenerator: taille de grille invalide");
+		if(perturbation < 0 || perturbation >= 1)
+			throw std::invalid_argument("GraphGenerator: perturbation hors de [0,1[");
+
+		Edges a;
+		a.V = rows * cols;
+		// la ligne r a cols-1 aretes horizontales et, sauf la derniere, cols verticales
+		size_t perRow = 2 * size_t(cols) - 1;
+		resize(a, size_t(rows) * perRow - cols);
+
+		pool.ParallelTasks(rows, [&](int r) {
+			Random rng = blockRng(seed, WeightStream, r);
+			size_t i = size_t(r) * perRow;
+			for(int c = 0; c < cols; ++c) {
+				int v = r * cols + c;
+				if(c + 1 < cols) {
+					a.from[i] = v; a.to[i] = v + 1;
+					a.weight[i++] = 1 + perturbation * (2 * uniform(rng) - 1);
+				}
+				if(r + 1 < rows) {
+					a.from[i] = v; a.to[i] = v + cols;
+					a.weight[i++] = 1 + perturbation * (2 * uniform(rng) - 1);
+				}
+			}
+		});
+		return a;
+	}
+
+	Edges RandomGeometric(int V, double averageDegree, uint64_t seed, ThreadPool& pool) {
+		if(V < 1 || averageDegree < 0)
+			throw std::invalid_argument("GraphGenerator: parametres invalides");
+
+		// degre moyen = V * pi * r^2, aux bords pres
+		const double pi = std::acos(-1.0);
+		double radius = std::sqrt(averageDegree / (pi * V));
+		// cellules de cote au moins radius: les voisins sont dans les 9
+		// cellules autour, et pas beaucoup plus de cellules que de points
+		int side = std::max(1, int(std::min(1 / std::max(radius, 1e-9), std::sqrt(double(V)))));
+		Points pts(V, side, seed, pool);
+
+		// Deux passes: on compte les aretes v-w (v < w) de chaque bloc de
+		// sommets, puis chaque bloc les ecrit a sa position
+		double radius2 = radius * radius;
+		auto forEachNeighbour = [&](int v, auto f) {
+			pts.forEachInRing(v, 0, [&](int w) { if(w > v && pts.squaredDistance(v, w) <= radius2) f(w); });
+			pts.forEachInRing(v, 1, [&](int w) { if(w > v && pts.squaredDistance(v, w) <= radius2) f(w); });
+		};
+		std::vector<size_t> start(blockCount(size_t(V)) + 1, 0);
+		forEachBlock(size_t(V), pool, [&](int b, size_t begin, size_t end) {
+			size_t n = 0;
+			for(size_t v = begin; v < end; ++v)
+				forEachNeighbour(int(v), [&](int) { ++n; });
+			start[b+1] = n;
+		});
+		for(size_t b = 0; b + 1 < start.size(); ++b) start[b+1] += start[b];
+
+		Edges a;
+		a.V = V;
+		resize(a, start.back());
+		forEachBlock(size_t(V), pool, [&](int b, size_t begin, size_t end) {
+			size_t i = start[b];
+			for(size_t v = begin; v < end; ++v)
+				forEachNeighbour(int(v), [&](int w) {
+					a.from[i] = int(v); a.to[i] = w;
+					a.weight[i++] = pts.distance(int(v), w);
+				});
+		});
+		return a;
+	}
+
+	Edges RMAT(int scale, int edgeFactor, uint64_t seed, ThreadPool& pool, RMATParameters p) {
+		if(scale < 1 || scale > 30 || edgeFactor < 1)
+			throw std::invalid_argument("GraphGenerator: parametres R-MAT invalides");
+		if(p.a < 0 || p.b < 0 || p.c < 0 || p.a + p.b + p.c > 1)
+			throw std::invalid_argument("GraphGenerator: probabilites R-MAT invalides");
+
+		Edges a;
+		a.V = 1 << scale;
+		resize(a, size_t(edgeFactor) << scale);
+
+		// melange des numeros: multiplication par un impair modulo 2^scale,
+		// qui est une bijection
+		uint64_t mask = uint64_t(a.V) - 1;
+		uint64_t multiplier = mix(seed) | 1, offset = mix(seed + 1);
+		auto scramble = [=](uint64_t v) { return int((v * multiplier + offset) & mask); };
+
+		// chaque niveau utilise 16 bits aleatoires, un tirage sert a 4 niveaux
+		const double unit = 65536;
+		uint64_t ta = uint64_t(p.a * unit), tb = uint64_t((p.a + p.b) * unit), tc = uint64_t((p.a + p.b + p.c) * unit);
+
+		int* from = a.from.data();
+		int* to = a.to.data();
+		double* weight = a.weight.data();
+		forEachBlock(a.from.size(), pool, [=](int b, size_t begin, size_t end) {
+			Random rng = blockRng(seed, ArcStream, b);
+			for(size_t i = begin; i < end; ++i) {
+				uint64_t u = 0, v = 0, bits = 0;
+				for(int bit = 0; bit < scale; ++bit) {
+					if(bit % 4 == 0) bits = rng();
+					uint64_t r = bits & 0xFFFF;
+					bits >>= 16;
+					// quadrants a: (0,0), b: (0,1), c: (1,0), d: (1,1). Les
+					// comparaisons sont combinees sans branchement car r est
+					// imprevisible.
+					u |= uint64_t(r >= tb) << bit;
+					v |= uint64_t((r >= ta) ^ (r >= tb) ^ (r >= tc)) << bit;
+				}
+				from[i] = scramble(u);
+				to[i] = scramble(v);
+				weight[i] = 1 - uniform(rng);
+			}
+		});
+		return a;
+	}
+
+	RailProfile Profile(const TrainNetwork& tn) {
+		RailProfile p;
+		for(const TrainNetwork::City& c : tn.cities)
+			p.degrees.push_back(int(c.lines.size()));
+		for(const TrainNetwork::Line& l : tn.lines)
+			p.lengths.push_back(l.length);
+		std::sort(p.lengths.begin(), p.lengths.end());
+		return p;
+	}
+
+	Edges RailLike(int V, const RailProfile& profile, uint64_t seed, ThreadPool& pool) {
+		if(V < 1 || profile.degrees.empty() || profile.lengths.empty())
+			throw std::invalid_argument("GraphGenerator: parametres invalides");
+		// chaque ville doit avoir au moins une voisine
+		if(V < 2)
+			throw std::invalid_argument("GraphGenerator: il faut au moins deux villes");
+
+		// environ deux villes par cellule
+		int side = std::max(1, int(std::sqrt(V / 2.0)));
+		Points pts(V, side, seed, pool);
+
+		// nombre de voisines de chaque ville
+		std::vector<int> k(V);
+		forEachBlock(size_t(V), pool, [&](int b, size_t begin, size_t end) {
+			Random rng = blockRng(seed, DegreeStream, b);
+			for(size_t v = begin; v < end; ++v) {
+				int d = profile.degrees[size_t(uniform(rng) * profile.degrees.size())];
+				// environ un tiers des voisines choisies choisissent aussi v
+				k[v] = std::min(V - 1, std::max(1, (2 * d + 1) / 3));
+			}
+		});
+		std::vector<size_t> start(V + 1, 0);
+		for(int v = 0; v < V; ++v) start[v+1] = start[v] + k[v];
+
+		// plus proches voisines: on elargit la recherche d'un anneau de
+		// cellules tant que l'anneau suivant peut contenir une ville plus
+		// proche que la k-ieme candidate. Les villes de l'anneau R sont a une
+		// distance d'au moins R-1 largeurs de cellule.
+		std::vector<std::pair<int,int>> pairs(start[V]);
+		double width = 1.0 / side;
+		forEachBlock(size_t(V), pool, [&](int, size_t begin, size_t end) {
+			std::vector<std::pair<double,int>> candidates;
+			for(size_t vv = begin; vv < end; ++vv) {
+				int v = int(vv);
+				candidates.clear();
+				for(int ring = 0; ring < side; ++ring) {
+					if(int(candidates.size()) >= k[v]) {
+						std::nth_element(candidates.begin(), candidates.begin() + k[v] - 1, candidates.end());
+						if((ring - 1) * width >= candidates[k[v] - 1].first) break;
+					}
+					pts.forEachInRing(v, ring, [&](int w) {
+						if(w != v) candidates.push_back(std::make_pair(pts.distance(v, w), w));
+					});
+				}
+				std::partial_sort(candidates.begin(), candidates.begin() + k[v], candidates.end());
+				for(int j = 0; j < k[v]; ++j) {
+					int w = candidates[j].second;
+					pairs[start[v] + j] = std::make_pair(std::min(v, w), std::max(v, w));
+				}
+			}
+		});
+
+		// une ligne choisie par ses deux villes n'est gardee qu'une fois
+		pool.ParallelSort(pairs.begin(), pairs.end(), std::less<std::pair<int,int>>());
+		pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+		// Les plus proches voisines forment des groupes isoles. Comme dans
+		// l'algorithme de Boruvka, chaque composante est reliee a la ville la
+		// plus proche hors d'elle, jusqu'a ce qu'il n'en reste qu'une. Pour
+		// que les villes au milieu des grandes composantes ne parcourent pas
+		// toute la grille, la recherche est limitee a maxRing anneaux, limite
+		// doublee quand aucune composante n'a trouve de voisine.
+		CompactUnionFind uf(V);
+		uf.UnionAll(pairs);
+		std::vector<int> component(V), nearest(V);
+		std::vector<double> nearestDistance(V);
+		int maxRing = 2;
+		while(uf.Count() > 1) {
+			for(int v = 0; v < V; ++v) component[v] = uf.Find(v);
+			forEachBlock(size_t(V), pool, [&](int, size_t begin, size_t end) {
+				for(size_t vv = begin; vv < end; ++vv) {
+					int v = int(vv), best = -1;
+					double bestDistance = 0;
+					for(int ring = 0; ring < side && ring <= maxRing; ++ring) {
+						if(best >= 0 && (ring - 1) * width >= bestDistance) break;
+						pts.forEachInRing(v, ring, [&](int w) {
+							if(component[w] == component[v]) return;
+							double d = pts.distance(v, w);
+							if(best < 0 || d < bestDistance || (d == bestDistance && w < best)) {
+								best = w;
+								bestDistance = d;
+							}
+						});
+					}
+					nearest[v] = best;
+					nearestDistance[v] = bestDistance;
+				}
+			});
+			std::vector<int> choice(V, -1);     // ville de la composante la plus proche d'une autre
+			for(int v = 0; v < V; ++v) {
+				if(nearest[v] < 0) continue;
+				int& c = choice[component[v]];
+				if(c < 0 || nearestDistance[v] < nearestDistance[c]) c = v;
+			}
+			bool linked = false;
+			for(int c = 0; c < V; ++c)
+				if(choice[c] >= 0 && uf.Unite(choice[c], nearest[choice[c]])) {
+					int v = choice[c], w = nearest[v];
+					pairs.push_back(std::make_pair(std::min(v, w), std::max(v, w)));
+					linked = true;
+				}
+			if(!linked) maxRing *= 2;
+		}
+
+		// les longueurs du profil sont attribuees dans l'ordre des distances
+		size_t E = pairs.size();
+		std::vector<std::pair<double,int>> byDistance(E);
+		pool.ParallelFor(0, int(E), [&](int begin, int end) {
+			for(int i = begin; i < end; ++i)
+				byDistance[i] = std::make_pair(pts.distance(pairs[i].first, pairs[i].second), i);
+		});
+		pool.ParallelSort(byDistance.begin(), byDistance.end(), std::less<std::pair<double,int>>());
+
+		Edges a;
+		a.V = V;
+		resize(a, E);
+		pool.ParallelFor(0, int(E), [&](int begin, int end) {
+			for(int r = begin; r < end; ++r) {
+				int i = byDistance[r].second;
+				a.from[i] = pairs[i].first;
+				a.to[i] = pairs[i].second;
+				a.weight[i] = profile.lengths[size_t(double(r) * profile.lengths.size() / E)];
+			}
+		});
+		return a;
+	}
+
+	Edges Symmetrize(const Edges& a) {
+		Edges s;
+		s.V = a.V;
+		s.from = a.from;
+		s.from.insert(s.from.end(), a.to.begin(), a.to.end());
+		s.to = a.to;
+		s.to.insert(s.to.end(), a.from.begin(), a.from.end());
+		s.weight = a.weight;
+		s.weight.insert(s.weight.end(), a.weight.begin(), a.weight.end());
+		return s;
+	}
+
+	void WriteEWD(const Edges& a, const std::string& filename, ThreadPool& pool) {
+		std::ofstream s(filename, std::ios::binary | std::ios::trunc);
+		s << a.V << "\n" << a.from.size() << "\n";
+
+		// les blocs sont formates par groupes pour borner la memoire, puis
+		// ecrits dans l'ordre
+		int blocks = blockCount(a.from.size());
+		int group = 4 * int(pool.Size());
+		std::vector<std::string> text(group);
+		for(int first = 0; first < blocks && s; first += group) {
+			int n = std::min(group, blocks - first);
+			pool.ParallelTasks(n, [&](int g) {
+				size_t begin = size_t(first + g) * BlockSize;
+				size_t end = std::min(a.from.size(), begin + BlockSize);
+				std::string& out = text[g];
+				out.resize((end - begin) * 48);
+				char* p = &out[0];
+				char* last = p + out.size();
+				for(size_t i = begin; i < end; ++i) {
+					p = std::to_chars(p, last, a.from[i]).ptr; *p++ = ' ';
+					p = std::to_chars(p, last, a.to[i]).ptr;   *p++ = ' ';
+					p = std::to_chars(p, last, a.weight[i]).ptr; *p++ = '\n';
+				}
+				out.resize(p - &out[0]);
+			});
+			for(int g = 0; g < n; ++g)
+				s.write(text[g].data(), std::streamsize(text[g].size()));
+		}
+		if(!s)
+			throw std::runtime_error("GraphGenerator: impossible d'ecrire " + filename);
+	}
+
+	Edges Grid(int rows, int cols, double perturbation, uint64_t seed) {
+		ThreadPool pool;
+		return Grid(rows, cols, perturbation, seed, pool);
+	}
+
+	Edges RandomGeometric(int V, double averageDegree, uint64_t seed) {
+		ThreadPool pool;
+		return RandomGeometric(V, averageDegree, seed, pool);
+	}
+
+	Edges RMAT(int scale, int edgeFactor, uint64_t seed, RMATParameters p) {
+		ThreadPool pool;
+		return RMAT(scale, edgeFactor, seed, pool, p);
+	}
+
+	Edges RailLike(int V, const RailProfile& profile, uint64_t seed) {
+		ThreadPool pool;
+		return RailLike(V, profile, seed, pool);
+	}
+
+	void WriteEWD(const Edges& a, const std::string& filename) {
+		ThreadPool pool;
+		WriteEWD(a, filename, pool);
+	}
+}
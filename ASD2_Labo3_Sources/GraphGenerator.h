@@ -0,0 +1,157 @@
+/*
+ * @file   GraphGenerator.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_GraphGenerator_h
+#define ASD2_GraphGenerator_h
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "EWDReader.h"
+#include "CSRGraph.h"
+#include "EdgeWeightedGraph.h"
+#include "EdgeWeightedDiGraph.h"
+#include "TrainNetwork.h"
+#include "ThreadPool.h"
+
+// Generateurs de graphes synthetiques pour tester les algorithmes sur de
+// gros graphes (jusqu'a 10^7 - 10^8 aretes):
+//
+// - Grid: grille 2D dont les poids valent 1 a une perturbation pres;
+// - RandomGeometric: points aleatoires du carre unite, relies s'ils sont a
+//   distance inferieure a un rayon, ponderes par leur distance;
+// - RMAT: graphe R-MAT (Chakrabarti et al.), a distribution des degres en loi
+//   de puissance, avec les parametres de Graph500 par defaut;
+// - RailLike: reseau ressemblant au reseau de trains, chaque ville etant
+//   reliee a ses plus proches voisines, avec les distributions des degres et
+//   des longueurs de lignes de TrainNetwork.
+//
+// Les aretes sont produites sous forme de tableaux (EWDReader::EdgeArrays),
+// a convertir en EdgeWeightedDiGraph, EdgeWeightedGraph, CSRDiGraph ou
+// CSRGraph, ou a ecrire au format EWD.
+//
+// La generation est parallele. Le travail est decoupe en blocs de taille
+// fixe, chacun avec son propre generateur aleatoire initialise a partir de
+// la graine et du numero du bloc: le graphe ne depend que de la graine, pas
+// du nombre de threads. Les nombres aleatoires sont convertis sans
+// std::uniform_real_distribution, dont le resultat depend de la
+// bibliotheque standard.
+
+namespace GraphGenerator {
+
+	typedef EWDReader::EdgeArrays<double> Edges;
+
+	/**
+	 * @brief Grille de rows x cols sommets, le sommet (r,c) etant r*cols+c.
+	 *        Chaque sommet est relie a ses voisins de droite et du bas.
+	 * @param perturbation, les poids sont tires uniformement dans
+	 *        [1-perturbation, 1+perturbation], 0 <= perturbation < 1
+	 */
+	Edges Grid(int rows, int cols, double perturbation, uint64_t seed, ThreadPool& pool);
+	Edges Grid(int rows, int cols, double perturbation, uint64_t seed);
+
+	/**
+	 * @brief Graphe geometrique aleatoire: V points du carre unite, relies si
+	 *        leur distance est inferieure au rayon donnant le degre moyen
+	 *        averageDegree. Le poids d'une arete est sa longueur.
+	 */
+	Edges RandomGeometric(int V, double averageDegree, uint64_t seed, ThreadPool& pool);
+	Edges RandomGeometric(int V, double averageDegree, uint64_t seed);
+
+	// Parametres du generateur R-MAT: probabilites de descendre dans chacun
+	// des quadrants de la matrice d'adjacence (d = 1 - a - b - c)
+	struct RMATParameters {
+		double a = 0.57;
+		double b = 0.19;
+		double c = 0.19;
+	};
+
+	/**
+	 * @brief Graphe R-MAT a 2^scale sommets et edgeFactor * 2^scale arcs, de
+	 *        poids uniformes dans ]0,1]. Les numeros des sommets sont melanges
+	 *        pour que les sommets de fort degre ne soient pas les premiers.
+	 *        Comme dans Graph500, les boucles et arcs multiples sont gardes.
+	 */
+	Edges RMAT(int scale, int edgeFactor, uint64_t seed, ThreadPool& pool, RMATParameters p = RMATParameters());
+	Edges RMAT(int scale, int edgeFactor, uint64_t seed, RMATParameters p = RMATParameters());
+
+	// Distributions empiriques imitees par RailLike
+	struct RailProfile {
+		std::vector<int> degrees;       // degre de chaque ville
+		std::vector<double> lengths;    // longueur des lignes, triees
+	};
+
+	/**
+	 * @brief Distributions des degres et des longueurs du reseau tn
+	 */
+	RailProfile Profile(const TrainNetwork& tn);
+
+	/**
+	 * @brief Reseau de V villes placees au hasard dans le carre unite.
+	 *        Chaque ville tire un degre d dans profile.degrees et se relie a
+	 *        ses (2d+1)/3 plus proches voisines, ce qui donne a peu pres la
+	 *        distribution des degres du profil (beaucoup de lignes sont
+	 *        choisies par leurs deux villes). Les longueurs des lignes suivent
+	 *        exactement la distribution du profil, attribuees dans l'ordre des
+	 *        distances: les lignes courtes relient les villes proches. Les
+	 *        groupes de villes ainsi formes sont ensuite relies par des
+	 *        lignes courtes: le reseau est connexe. Il faut V >= 2.
+	 */
+	Edges RailLike(int V, const RailProfile& profile, uint64_t seed, ThreadPool& pool);
+	Edges RailLike(int V, const RailProfile& profile, uint64_t seed);
+
+	/**
+	 * @brief Ajoute l'arc w->v pour chaque arc v->w, pour construire un
+	 *        graphe oriente a partir d'aretes non orientees
+	 */
+	Edges Symmetrize(const Edges& a);
+
+	/**
+	 * @brief Ecrit les aretes au format EWD, lisible par EWDReader et par les
+	 *        constructeurs d'EdgeWeightedGraph et EdgeWeightedDiGraph.
+	 *        Les lignes sont formatees en parallele.
+	 * @throw std::runtime_error en cas d'erreur d'ecriture
+	 */
+	void WriteEWD(const Edges& a, const std::string& filename, ThreadPool& pool);
+	void WriteEWD(const Edges& a, const std::string& filename);
+
+	// Graphe oriente au format CSR, un arc par element de a
+	template<typename T = double>
+	CSRDiGraph<T> MakeCSRDiGraph(const Edges& a) {
+		std::vector<T> weight(a.weight.begin(), a.weight.end());
+		return CSRDiGraph<T>(CSRDiGraph<T>::BuildStorage(a.V, a.from, a.to, weight, false));
+	}
+
+	// Graphe non oriente au format CSR, une arete par element de a
+	template<typename T = double>
+	CSRGraph<T> MakeCSRGraph(const Edges& a) {
+		std::vector<T> weight(a.weight.begin(), a.weight.end());
+		return CSRGraph<T>(CSRGraph<T>::BuildStorage(a.V, a.from, a.to, weight, true));
+	}
+
+	// Graphe oriente a listes d'adjacence, un arc par element de a
+	template<typename T = double>
+	EdgeWeightedDiGraph<T> MakeDiGraph(const Edges& a) {
+		EdgeWeightedDiGraph<T> g(a.V);
+		for(size_t i = 0; i < a.from.size(); ++i)
+			g.addEdge(a.from[i], a.to[i], T(a.weight[i]));
+		return g;
+	}
+
+	// Graphe non oriente a listes d'adjacence, une arete par element de a
+	template<typename T = double>
+	EdgeWeightedGraph<T> MakeGraph(const Edges& a) {
+		EdgeWeightedGraph<T> g(a.V);
+		for(size_t i = 0; i < a.from.size(); ++i)
+			g.addEdge(a.from[i], a.to[i], T(a.weight[i]));
+		return g;
+	}
+}
+
+#endif
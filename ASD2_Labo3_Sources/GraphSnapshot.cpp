@@ -0,0 +1,89 @@
+/*
+ * @file   GraphSnapshot.cpp
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#include <limits>
+
+#include "GraphSnapshot.h"
+#include "TrainGraphWrapper.h"
+
+namespace GraphSnapshot {
+
+	Layout::Layout(uint64_t V, uint64_t entries, size_t weightSize) {
+		offsets = sizeof(Header);
+		targets = offsets + size_t(V + 1) * sizeof(int32_t);
+		weights = targets + size_t(entries) * sizeof(int32_t);
+		weights = (weights + 7) & ~size_t(7);
+		size = weights + size_t(entries) * weightSize;
+	}
+
+	uint64_t Checksum(const char* data, size_t size) {
+		const uint64_t prime = 1099511628211ULL;
+		uint64_t h = 14695981039346656037ULL;
+		size_t i = 0;
+		for(; i + 8 <= size; i += 8) {
+			uint64_t w;
+			std::memcpy(&w, data + i, 8);
+			h = (h ^ w) * prime;
+		}
+		for(; i < size; ++i)
+			h = (h ^ uint64_t(uint8_t(data[i]))) * prime;
+		return h;
+	}
+
+	Layout Check(const MappedFile& file, uint32_t weightType, bool directed, bool verify) {
+		if(file.Size() < sizeof(Header))
+			throw std::runtime_error("GraphSnapshot: fichier trop court");
+
+		Header h;
+		std::memcpy(&h, file.Data(), sizeof(h));
+		if(std::strncmp(h.magic, "ASD2CSR", 8) != 0)
+			throw std::runtime_error("GraphSnapshot: ce n'est pas un snapshot de graphe");
+		if(h.byteOrder != 0x01020304)
+			throw std::runtime_error("GraphSnapshot: ordre des octets incompatible");
+		if(h.version != Version)
+			throw std::runtime_error("GraphSnapshot: version non supportee");
+		if(h.weightType != weightType)
+			throw std::runtime_error("GraphSnapshot: type de poids incompatible");
+		if(h.directed != (directed ? 1u : 0u))
+			throw std::runtime_error("GraphSnapshot: orientation incompatible");
+
+		// les graphes CSR indexent sommets et entrees par des int
+		if(h.V >= uint64_t(std::numeric_limits<int>::max()) || h.entries > uint64_t(std::numeric_limits<int>::max()))
+			throw std::runtime_error("GraphSnapshot: graphe trop grand");
+
+		size_t weightSize = weightType == Int32 || weightType == Float ? 4 : 8;
+		Layout layout(h.V, h.entries, weightSize);
+		if(file.Size() != layout.size)
+			throw std::runtime_error("GraphSnapshot: taille de fichier incoherente");
+
+		if(verify && Checksum(file.Data() + sizeof(Header), file.Size() - sizeof(Header)) != h.checksum)
+			throw std::runtime_error("GraphSnapshot: somme de controle invalide");
+
+		// Meme sans verify, la structure est toujours verifiee, en O(V+E):
+		// un fichier corrompu de la bonne taille ferait sinon lire les
+		// algorithmes hors des tableaux.
+		int V = int(h.V), entries = int(h.entries);
+		const int32_t* offsets = reinterpret_cast<const int32_t*>(file.Data() + layout.offsets);
+		const int32_t* targets = reinterpret_cast<const int32_t*>(file.Data() + layout.targets);
+		if(offsets[0] != 0 || offsets[V] != entries)
+			throw std::runtime_error("GraphSnapshot: tableau des offsets invalide");
+		for(int v = 0; v < V; ++v)
+			if(offsets[v] > offsets[v+1])
+				throw std::runtime_error("GraphSnapshot: tableau des offsets invalide");
+		for(int i = 0; i < entries; ++i)
+			if(targets[i] < 0 || targets[i] >= V)
+				throw std::runtime_error("GraphSnapshot: sommet hors limites");
+
+		return layout;
+	}
+
+	void ConvertTrainNetwork(const TrainNetwork& tn, const std::string& snapshotFile,
+	                         std::function<int(const TrainNetwork::Line&)> fnWeight) {
+		Write(CachedTrainDiGraphWrapper(tn, fnWeight), snapshotFile);
+	}
+}
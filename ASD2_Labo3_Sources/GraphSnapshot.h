@@ -0,0 +1,193 @@
+/*
+ * @file   GraphSnapshot.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_GraphSnapshot_h
+#define ASD2_GraphSnapshot_h
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <stdexcept>
+#include <functional>
+
+#include "MappedFile.h"
+#include "CSRGraph.h"
+#include "EWDReader.h"
+#include "TrainNetwork.h"
+
+// Format binaire de sauvegarde des graphes CSR. Le fichier contient:
+//
+//   Header                      (48 octets)
+//   offsets   int32_t[V+1]
+//   targets   int32_t[entries]
+//   (bourrage jusqu'a un multiple de 8 octets)
+//   weights   WeightType[entries]
+//
+// Les donnees sont ecrites dans l'ordre des octets de la machine. A
+// l'ouverture, le fichier est projete en memoire et le graphe renvoye
+// pointe directement dans la projection: rien n'est copie. La structure
+// est toutefois toujours verifiee (offsets croissants, cibles dans [0,V)),
+// ce qui lit les offsets et les cibles en O(V+E), soit environ un tiers du
+// fichier pour des poids double. Seuls les poids ne sont lus qu'a la
+// demande. verify ajoute la somme de controle et lit tout le fichier.
+
+namespace GraphSnapshot {
+
+	// Version courante du format
+	const uint32_t Version = 1;
+
+	// Codes des types de poids
+	enum WeightCode : uint32_t { Int32 = 1, Int64 = 2, Float = 3, Double = 4 };
+
+	template<typename T> struct WeightTypeOf;
+	template<> struct WeightTypeOf<int32_t> { static const uint32_t code = Int32; };
+	template<> struct WeightTypeOf<int64_t> { static const uint32_t code = Int64; };
+	template<> struct WeightTypeOf<float>   { static const uint32_t code = Float; };
+	template<> struct WeightTypeOf<double>  { static const uint32_t code = Double; };
+
+	// En-tete du fichier
+	struct Header {
+		char     magic[8];       // "ASD2CSR"
+		uint32_t version;        // Version
+		uint32_t byteOrder;      // 0x01020304 dans l'ordre de la machine qui a ecrit
+		uint32_t weightType;     // WeightCode
+		uint32_t directed;       // 1 pour un CSRDiGraph, 0 pour un CSRGraph
+		uint64_t V;              // nombre de sommets
+		uint64_t entries;        // nombre d'entrees d'adjacence
+		uint64_t checksum;       // Checksum() des donnees suivant l'en-tete
+	};
+	static_assert(sizeof(Header) == 48, "GraphSnapshot: en-tete mal aligne");
+
+	// Position des tableaux dans le fichier
+	struct Layout {
+		size_t offsets, targets, weights, size;
+		Layout(uint64_t V, uint64_t entries, size_t weightSize);
+	};
+
+	/**
+	 * @brief Somme de controle 64 bits (FNV-1a sur des mots de 8 octets)
+	 */
+	uint64_t Checksum(const char* data, size_t size);
+
+	/**
+	 * @brief Verifie l'en-tete d'un fichier projete et renvoie son Layout
+	 * @throw std::runtime_error si le fichier n'est pas un snapshot valide
+	 *        de ce type, si sa structure est incoherente (en O(V+E)), ou si
+	 *        verify est vrai et que la somme de controle ne correspond pas
+	 */
+	Layout Check(const MappedFile& file, uint32_t weightType, bool directed, bool verify);
+
+	/**
+	 * @brief Ecrit le graphe CSR g dans le fichier filename
+	 * @throw std::runtime_error en cas d'erreur d'ecriture
+	 */
+	template<typename GraphType> // CSRDiGraph<T> ou CSRGraph<T>
+	void Write(const GraphType& g, const std::string& filename, bool directed) {
+		typedef typename GraphType::WeightType T;
+		uint64_t V = uint64_t(g.V()), entries = uint64_t(g.Entries());
+		Layout layout(V, entries, sizeof(T));
+
+		std::vector<char> payload(layout.size - sizeof(Header), 0);
+		if(g.V() > 0)
+			std::memcpy(&payload[layout.offsets - sizeof(Header)], g.Offsets(), (V+1) * sizeof(int32_t));
+		if(entries > 0) {
+			std::memcpy(&payload[layout.targets - sizeof(Header)], g.Targets(), entries * sizeof(int32_t));
+			std::memcpy(&payload[layout.weights - sizeof(Header)], g.Weights(), entries * sizeof(T));
+		}
+
+		Header h;
+		std::memset(&h, 0, sizeof(h));
+		std::strcpy(h.magic, "ASD2CSR");
+		h.version = Version;
+		h.byteOrder = 0x01020304;
+		h.weightType = WeightTypeOf<T>::code;
+		h.directed = directed ? 1 : 0;
+		h.V = V;
+		h.entries = entries;
+		h.checksum = Checksum(payload.data(), payload.size());
+
+		std::ofstream s(filename, std::ios::binary | std::ios::trunc);
+		s.write(reinterpret_cast<const char*>(&h), sizeof(h));
+		s.write(payload.data(), std::streamsize(payload.size()));
+		if(!s)
+			throw std::runtime_error("GraphSnapshot: impossible d'ecrire " + filename);
+	}
+
+	// Ecrit un graphe oriente
+	template<typename T>
+	void Write(const CSRDiGraph<T>& g, const std::string& filename) {
+		Write(g, filename, true);
+	}
+
+	// Ecrit un graphe non oriente
+	template<typename T>
+	void Write(const CSRGraph<T>& g, const std::string& filename) {
+		Write(g, filename, false);
+	}
+
+	namespace detail {
+		template<typename GraphType, typename T>
+		GraphType open(const std::string& filename, bool directed, bool verify) {
+			auto file = std::make_shared<const MappedFile>(filename);
+			Layout layout = Check(*file, WeightTypeOf<T>::code, directed, verify);
+			const Header* h = reinterpret_cast<const Header*>(file->Data());
+			const char* base = file->Data();
+			return GraphType(file, int(h->V),
+			                 reinterpret_cast<const int*>(base + layout.offsets),
+			                 reinterpret_cast<const int*>(base + layout.targets),
+			                 reinterpret_cast<const T*>(base + layout.weights));
+		}
+	}
+
+	/**
+	 * @brief Ouvre un graphe oriente sauvegarde. Le graphe renvoye lit ses
+	 *        arcs directement dans le fichier projete en memoire. Les
+	 *        offsets et les cibles sont lus pour verifier la structure.
+	 * @param verify si vrai, la somme de controle est verifiee (lecture
+	 *        complete du fichier)
+	 */
+	template<typename T>
+	CSRDiGraph<T> OpenDiGraph(const std::string& filename, bool verify = false) {
+		return detail::open<CSRDiGraph<T>,T>(filename, true, verify);
+	}
+
+	/**
+	 * @brief Ouvre un graphe non oriente sauvegarde.
+	 * @param verify si vrai, la somme de controle est verifiee
+	 */
+	template<typename T>
+	CSRGraph<T> OpenGraph(const std::string& filename, bool verify = false) {
+		return detail::open<CSRGraph<T>,T>(filename, false, verify);
+	}
+
+	/**
+	 * @brief Convertit un fichier texte au format EWD en snapshot
+	 * @param directed vrai pour un graphe oriente, faux pour un graphe non oriente
+	 */
+	template<typename T>
+	void ConvertEWD(const std::string& ewdFile, const std::string& snapshotFile, bool directed = true) {
+		if(directed)
+			Write(EWDReader::ReadDiGraph<T>(ewdFile), snapshotFile);
+		else
+			Write(EWDReader::ReadGraph<T>(ewdFile), snapshotFile);
+	}
+
+	/**
+	 * @brief Convertit un reseau ferroviaire (reseau.txt) en snapshot oriente,
+	 *        chaque ligne donnant un arc dans chaque sens. Les noms des villes
+	 *        ne sont pas sauvegardes, les sommets sont les indices de tn.cities.
+	 * @param fnWeight poids d'une ligne. Les lignes de poids
+	 *        numeric_limits<int>::max() sont ignorees.
+	 */
+	void ConvertTrainNetwork(const TrainNetwork& tn, const std::string& snapshotFile,
+	                         std::function<int(const TrainNetwork::Line&)> fnWeight);
+}
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * @file   IndexMinPQ.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_IndexMinPQ_h
+#define ASD2_IndexMinPQ_h
+
+#include <vector>
+#include <utility>
+#include <functional>
+
+// Queue de priorite indexee (tas d-aire) sur les entiers 0..N-1.
+// Chaque indice i est associe a une cle. Contrairement a std::priority_queue,
+// elle permet de diminuer la cle d'un element deja present (decrease-key)
+// en O(log_D N), ce qui en fait la structure de base de Dijkstra et de Prim.
+//
+// Les cles sont stockees directement dans le tas a cote de l'indice pour
+// que les comparaisons lors des remontees/descentes restent contigues en
+// memoire. qp[i] donne la position de i dans le tas, -1 s'il est absent.
+
+template<typename Key,                    // Type des cles, normalement le type des poids
+         int D = 2,                       // Arite du tas (2, 4, 8, ...)
+         typename Compare = std::less<Key>>
+class IndexMinPQ {
+	static_assert(D >= 2, "IndexMinPQ: l'arite doit etre au moins 2");
+
+public:
+	typedef std::pair<Key,int> Entry;
+
+private:
+	std::vector<Entry> heap;   // (cle, indice), heap[0] est le minimum
+	std::vector<int> qp;       // position de chaque indice dans heap, -1 si absent
+	Compare less;
+
+public:
+	/**
+	 * @brief Constructeur
+	 * @param N nombre d'indices possibles (0..N-1)
+	 */
+	explicit IndexMinPQ(int N = 0) : qp(N, -1) {
+		heap.reserve(N);
+	}
+
+	/**
+	 * @brief Redimensionne la queue pour N indices. La queue est videe.
+	 * @param N nombre d'indices possibles
+	 */
+	void Resize(int N) {
+		heap.clear();
+		qp.assign(N, -1);
+	}
+
+	// Indique si la queue est vide
+	bool Empty() const { return heap.empty(); }
+
+	// Nombre d'elements dans la queue
+	int Size() const { return int(heap.size()); }
+
+	// Indique si l'indice i est dans la queue
+	bool Contains(int i) const { return qp[i] != -1; }
+
+	// Renvoie l'indice de cle minimale
+	int Top() const { return heap.front().second; }
+
+	// Renvoie la cle minimale
+	const Key& TopKey() const { return heap.front().first; }
+
+	// Renvoie la cle associee a l'indice i (qui doit etre present)
+	const Key& KeyOf(int i) const { return heap[qp[i]].first; }
+
+	/**
+	 * @brief Insere l'indice i (absent de la queue) avec la cle k
+	 */
+	void Push(int i, const Key& k) {
+		qp[i] = int(heap.size());
+		heap.emplace_back(k, i);
+		swim(qp[i]);
+	}
+
+	/**
+	 * @brief Diminue la cle de l'indice i (present dans la queue) a k
+	 */
+	void DecreaseKey(int i, const Key& k) {
+		heap[qp[i]].first = k;
+		swim(qp[i]);
+	}
+
+	/**
+	 * @brief Change la cle de l'indice i (present dans la queue) a k, qu'elle
+	 *        augmente ou diminue
+	 */
+	void ChangeKey(int i, const Key& k) {
+		heap[qp[i]].first = k;
+		swim(qp[i]);
+		sink(qp[i]);
+	}
+
+	/**
+	 * @brief Insere i avec la cle k, ou diminue sa cle s'il est deja present.
+	 * @return true si i etait deja dans la queue (decrease-key)
+	 */
+	bool PushOrDecrease(int i, const Key& k) {
+		if(Contains(i)) {
+			DecreaseKey(i, k);
+			return true;
+		}
+		Push(i, k);
+		return false;
+	}
+
+	/**
+	 * @brief Retire l'element de cle minimale
+	 * @return son indice
+	 */
+	int Pop() {
+		int top = heap.front().second;
+		qp[top] = -1;
+		if(heap.size() > 1) {
+			heap.front() = heap.back();
+			heap.pop_back();
+			qp[heap.front().second] = 0;
+			sink(0);
+		} else {
+			heap.pop_back();
+		}
+		return top;
+	}
+
+	/**
+	 * @brief Vide la queue. Ne touche que les indices encore presents,
+	 *        la queue peut donc etre reutilisee sans cout en O(N).
+	 */
+	void Clear() {
+		for(const Entry& e : heap)
+			qp[e.second] = -1;
+		heap.clear();
+	}
+
+private:
+	bool greater(const Entry& a, const Entry& b) const {
+		return less(b.first, a.first);
+	}
+
+	// remonte l'element en position k tant qu'il est plus petit que son parent
+	void swim(int k) {
+		Entry e = heap[k];
+		while(k > 0) {
+			int parent = (k - 1) / D;
+			if(!greater(heap[parent], e)) break;
+			heap[k] = heap[parent];
+			qp[heap[k].second] = k;
+			k = parent;
+		}
+		heap[k] = e;
+		qp[e.second] = k;
+	}
+
+	// descend l'element en position k tant qu'un de ses enfants est plus petit
+	void sink(int k) {
+		int n = int(heap.size());
+		Entry e = heap[k];
+		for(;;) {
+			int first = D * k + 1;
+			if(first >= n) break;
+			int last = first + D < n ? first + D : n;
+			int child = first;
+			for(int c = first + 1; c < last; ++c)
+				if(greater(heap[child], heap[c]))
+					child = c;
+			if(!greater(e, heap[child])) break;
+			heap[k] = heap[child];
+			qp[heap[k].second] = k;
+			k = child;
+		}
+		heap[k] = e;
+		qp[e.second] = k;
+	}
+};
+
+#endif
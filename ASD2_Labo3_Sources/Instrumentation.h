@@ -0,0 +1,123 @@
+/*
+ * @file   Instrumentation.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_Instrumentation_h
+#define ASD2_Instrumentation_h
+
+#include <algorithm>
+
+#include "Benchmark.h"
+
+// Politiques d'instrumentation des algorithmes de plus courts chemins et
+// d'arbre couvrant minimum. L'algorithme recoit la politique en parametre
+// du template et l'appelle a chaque operation de sa boucle principale:
+//
+// - NoInstrumentation (par defaut) ne fait rien. Ses methodes sont vides et
+//   inline, le compilateur les supprime: l'algorithme n'est pas ralenti;
+// - CountingInstrumentation compte les operations et mesure la duree des
+//   phases dans un SearchStats.
+//
+// Le code qui n'a de sens que pour compter (par exemple suivre la
+// profondeur des chemins de l'union-find) est place dans un
+// if constexpr (Instrumentation::Enabled).
+
+// Phases mesurees
+enum class Phase {
+	Setup,      // initialisation: tableaux, collecte des aretes
+	Sort,       // tri des aretes (Kruskal)
+	Search,     // boucle principale
+	Count
+};
+
+// Compteurs d'un calcul. Chaque algorithme ne remplit que ceux qui le
+// concernent.
+struct SearchStats {
+	long settled = 0;         // sommets fixes (Dijkstra, Prim), aretes acceptees (Kruskal)
+	long scanned = 0;         // arcs examines, aretes sorties de la queue (Kruskal)
+	long relaxations = 0;     // arcs ayant diminue une distance ou une cle
+	long pushes = 0;          // insertions dans la queue de priorite
+	long decreaseKeys = 0;    // diminutions de cle dans la queue
+	long queuePeak = 0;       // taille maximale de la queue
+	long passes = 0;          // passes sur tous les arcs (Bellman-Ford)
+	long finds = 0;           // recherches de racine dans l'union-find
+	long findSteps = 0;       // liens parcourus par ces recherches
+	long findDepthMax = 0;    // plus long chemin parcouru par une recherche
+	double phaseSeconds[int(Phase::Count)] = {};
+
+	// Duree d'une phase, en secondes
+	double Seconds(Phase p) const { return phaseSeconds[int(p)]; }
+};
+
+class NoInstrumentation {
+public:
+	static constexpr bool Enabled = false;
+
+	struct Timer { };
+
+	void Settle() { }
+	void Scan() { }
+	void Relax() { }
+	void Enqueue(bool /* decrease */, int /* queueSize */) { }
+	void Pass() { }
+	void Find(int /* steps */) { }
+	Timer Start() const { return Timer(); }
+	void Stop(Phase, const Timer&) { }
+
+	void Reset() { }
+	SearchStats Stats() const { return SearchStats(); }
+};
+
+class CountingInstrumentation {
+private:
+	SearchStats stats;
+
+public:
+	static constexpr bool Enabled = true;
+
+	typedef Stopwatch Timer;
+
+	// Un sommet est fixe (ou une arete acceptee)
+	void Settle() { ++stats.settled; }
+
+	// Un arc est examine
+	void Scan() { ++stats.scanned; }
+
+	// Un arc diminue une distance
+	void Relax() { ++stats.relaxations; }
+
+	// Un sommet est insere dans la queue, ou sa cle diminue si decrease
+	void Enqueue(bool decrease, int queueSize) {
+		if(decrease) ++stats.decreaseKeys;
+		else ++stats.pushes;
+		stats.queuePeak = std::max(stats.queuePeak, long(queueSize));
+	}
+
+	// Une passe sur tous les arcs commence
+	void Pass() { ++stats.passes; }
+
+	// Une recherche de racine a parcouru steps liens
+	void Find(int steps) {
+		++stats.finds;
+		stats.findSteps += steps;
+		stats.findDepthMax = std::max(stats.findDepthMax, long(steps));
+	}
+
+	// Debut d'une phase
+	Timer Start() const { return Timer(); }
+
+	// Fin de la phase p commencee par Start
+	void Stop(Phase p, const Timer& t) { stats.phaseSeconds[int(p)] += t.Seconds(); }
+
+	// Remet les compteurs a zero
+	void Reset() { stats = SearchStats(); }
+
+	// Compteurs accumules depuis la creation ou le dernier Reset
+	const SearchStats& Stats() const { return stats; }
+};
+
+#endif
@@ -0,0 +1,338 @@
+/*
+ * @file   LandmarkSP.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_LandmarkSP_h
+#define ASD2_LandmarkSP_h
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#include "PointToPointSP.h"
+#include "ShortestPath.h"
+#include "GraphSnapshot.h"
+#include "TrainGraphWrapper.h"
+
+// Algorithme ALT (A*, Landmarks, Triangle inequality). On choisit quelques
+// sommets reperes L et on precalcule d(L,v) et d(v,L) pour tous les sommets
+// v. Par l'inegalite triangulaire, pour tout sommet v et destination t:
+//
+//   d(v,t) >= d(L,t) - d(L,v)    et    d(v,t) >= d(v,L) - d(t,L)
+//
+// Le maximum de ces bornes sur tous les reperes est une heuristique
+// admissible et consistante pour A*, qui explore alors surtout les sommets
+// en direction de t. Les reperes sont choisis par l'heuristique du point
+// le plus eloigne: chaque nouveau repere est le sommet le plus loin des
+// reperes deja choisis.
+//
+// Les tables peuvent etre sauvegardees dans un fichier a cote du graphe
+// pour ne pas les recalculer a chaque demarrage.
+
+template<typename GraphType> // Type du graphe pondere oriente a traiter
+							 // GraphType doit se comporter comme un
+							 // EdgeWeightedDiGraph et definir V() et
+							 // forEachAdjacentEdge(int,Func), ainsi que le type GraphType::Edge.
+class ALTSP {
+public:
+	typedef typename GraphType::Edge Edge;
+	typedef typename Edge::WeightType Weight;
+	typedef std::vector<Edge> Edges;
+
+private:
+	// En-tete du fichier des tables
+	struct Header {
+		char     magic[8];       // "ASD2ALT"
+		uint32_t version;
+		uint32_t weightType;     // GraphSnapshot::WeightCode
+		uint32_t V;
+		uint32_t L;              // nombre de reperes
+		uint64_t graph;          // empreinte du graphe, voir fingerprint()
+		uint64_t checksum;       // GraphSnapshot::Checksum des donnees suivant l'en-tete
+	};
+
+	CSRDiGraph<Weight> forward;
+	CSRDiGraph<Weight> backward;
+
+	std::vector<int> landmarks;
+	std::vector<Weight> fromL;   // fromL[v*L+l] = d(landmarks[l], v)
+	std::vector<Weight> toL;     // toL[v*L+l] = d(v, landmarks[l])
+
+	// Ajoute le repere r et calcule ses tables
+	void addLandmark(int r) {
+		int V = forward.V();
+		int L = int(landmarks.size()) + 1;
+		DijkstraSP<CSRDiGraph<Weight>> from(forward, r), to(backward, r);
+
+		std::vector<Weight> newFrom(size_t(V) * L), newTo(size_t(V) * L);
+		for(int v = 0; v < V; ++v) {
+			for(int l = 0; l < L - 1; ++l) {
+				newFrom[size_t(v)*L + l] = fromL[size_t(v)*(L-1) + l];
+				newTo[size_t(v)*L + l] = toL[size_t(v)*(L-1) + l];
+			}
+			newFrom[size_t(v)*L + L-1] = from.DistanceTo(v);
+			newTo[size_t(v)*L + L-1] = to.DistanceTo(v);
+		}
+		fromL.swap(newFrom);
+		toL.swap(newTo);
+		landmarks.push_back(r);
+	}
+
+	// Choisit nbLandmarks reperes par l'heuristique du point le plus eloigne
+	void selectLandmarks(int nbLandmarks) {
+		const Weight INF = std::numeric_limits<Weight>::max();
+		int V = forward.V();
+		if(V == 0) return;
+		if(nbLandmarks > V) nbLandmarks = V;
+
+		// premier repere: le sommet le plus eloigne du sommet 0
+		std::vector<Weight> minDist(V, INF);
+		{
+			DijkstraSP<CSRDiGraph<Weight>> sp(forward, 0);
+			int far = 0;
+			for(int v = 0; v < V; ++v)
+				if(sp.DistanceTo(v) != INF && sp.DistanceTo(v) > sp.DistanceTo(far))
+					far = v;
+			addLandmark(far);
+		}
+
+		while(int(landmarks.size()) < nbLandmarks) {
+			int L = int(landmarks.size());
+			int next = -1;
+			for(int v = 0; v < V; ++v) {
+				Weight d = fromL[size_t(v)*L + L-1];
+				if(d < minDist[v]) minDist[v] = d;
+				// un sommet inatteignable depuis tous les reperes est choisi en priorite
+				if(next < 0 || minDist[v] > minDist[next])
+					next = v;
+			}
+			if(minDist[next] == 0) break;   // tous les sommets sont des reperes
+			addLandmark(next);
+		}
+	}
+
+	// Empreinte du graphe: les tables d'un autre graphe de meme taille (par
+	// exemple apres modification d'une longueur de ligne) donneraient des
+	// bornes fausses et des chemins faux.
+	uint64_t fingerprint() const {
+		int V = forward.V(), E = forward.Entries();
+		uint64_t h = uint64_t(uint32_t(V)) << 32 | uint32_t(E);
+		for(uint64_t c : { GraphSnapshot::Checksum((const char*)forward.Offsets(), size_t(V+1) * sizeof(int)),
+		                   GraphSnapshot::Checksum((const char*)forward.Targets(), size_t(E) * sizeof(int)),
+		                   GraphSnapshot::Checksum((const char*)forward.Weights(), size_t(E) * sizeof(Weight)) })
+			h = (h ^ c) * 0x100000001b3ULL;
+		return h;
+	}
+
+	// Borne inferieure de d(v,t)
+	Weight lowerBound(int v, int t) const {
+		const Weight INF = std::numeric_limits<Weight>::max();
+		int L = int(landmarks.size());
+		const Weight* fv = &fromL[size_t(v)*L];
+		const Weight* ft = &fromL[size_t(t)*L];
+		const Weight* tv = &toL[size_t(v)*L];
+		const Weight* tt = &toL[size_t(t)*L];
+		Weight h = 0;
+		for(int l = 0; l < L; ++l) {
+			if(fv[l] != INF && ft[l] != INF && ft[l] - fv[l] > h) h = ft[l] - fv[l];
+			if(tv[l] != INF && tt[l] != INF && tv[l] - tt[l] > h) h = tv[l] - tt[l];
+		}
+		return h;
+	}
+
+public:
+	/**
+	 * @brief Constructeur. Fige g et calcule les tables des reperes.
+	 * @param g, graphe dans lequel on veut faire des recherches
+	 * @param nbLandmarks, nombre de reperes
+	 */
+	ALTSP(const GraphType& g, int nbLandmarks = 8)
+		: forward(g), backward(Reverse(forward))
+	{
+		selectLandmarks(nbLandmarks);
+	}
+
+	/**
+	 * @brief Constructeur. Relit les tables du fichier filename si elles
+	 *        correspondent au graphe, sinon les calcule et les y sauvegarde.
+	 * @param g, graphe dans lequel on veut faire des recherches
+	 * @param filename, fichier des tables
+	 * @param nbLandmarks, nombre de reperes
+	 */
+	ALTSP(const GraphType& g, const std::string& filename, int nbLandmarks = 8)
+		: forward(g), backward(Reverse(forward))
+	{
+		if(!Load(filename) || int(landmarks.size()) != std::min(nbLandmarks, forward.V())) {
+			landmarks.clear(); fromL.clear(); toL.clear();
+			selectLandmarks(nbLandmarks);
+			Save(filename);
+		}
+	}
+
+	// Reperes utilises
+	const std::vector<int>& Landmarks() const { return landmarks; }
+
+	/**
+	 * @brief Sauvegarde les reperes et leurs tables dans le fichier filename
+	 * @throw std::runtime_error en cas d'erreur d'ecriture
+	 */
+	void Save(const std::string& filename) const {
+		std::vector<char> payload;
+		auto append = [&payload](const void* p, size_t n) {
+			payload.insert(payload.end(), (const char*)p, (const char*)p + n);
+		};
+		append(landmarks.data(), landmarks.size() * sizeof(int));
+		append(fromL.data(), fromL.size() * sizeof(Weight));
+		append(toL.data(), toL.size() * sizeof(Weight));
+
+		Header h;
+		std::memset(&h, 0, sizeof(h));
+		std::strcpy(h.magic, "ASD2ALT");
+		h.version = 2;
+		h.weightType = GraphSnapshot::WeightTypeOf<Weight>::code;
+		h.V = uint32_t(forward.V());
+		h.L = uint32_t(landmarks.size());
+		h.graph = fingerprint();
+		h.checksum = GraphSnapshot::Checksum(payload.data(), payload.size());
+
+		std::ofstream s(filename, std::ios::binary | std::ios::trunc);
+		s.write((const char*)&h, sizeof(h));
+		s.write(payload.data(), std::streamsize(payload.size()));
+		if(!s)
+			throw std::runtime_error("ALTSP: impossible d'ecrire " + filename);
+	}
+
+	/**
+	 * @brief Relit les reperes et leurs tables depuis le fichier filename
+	 * @return false si le fichier n'existe pas, est tronque ou a ete calcule
+	 *         pour un autre graphe
+	 */
+	bool Load(const std::string& filename) {
+		std::ifstream s(filename, std::ios::binary | std::ios::ate);
+		std::streamoff fileSize = s.tellg();
+		s.seekg(0);
+		Header h;
+		if(!s.read((char*)&h, sizeof(h))) return false;
+		if(std::strncmp(h.magic, "ASD2ALT", 8) != 0 || h.version != 2
+		   || h.weightType != GraphSnapshot::WeightTypeOf<Weight>::code
+		   || h.V != uint32_t(forward.V()) || h.L > h.V
+		   || h.graph != fingerprint())
+			return false;
+
+		// la taille est verifiee avant l'allocation
+		size_t n = size_t(h.V) * h.L;
+		size_t size = h.L * sizeof(int) + 2 * n * sizeof(Weight);
+		if(fileSize < 0 || size_t(fileSize) != sizeof(h) + size) return false;
+		std::vector<char> payload(size);
+		if(!s.read(payload.data(), std::streamsize(payload.size()))
+		   || GraphSnapshot::Checksum(payload.data(), payload.size()) != h.checksum)
+			return false;
+
+		landmarks.resize(h.L);
+		fromL.resize(n);
+		toL.resize(n);
+		const char* p = payload.data();
+		std::memcpy(landmarks.data(), p, h.L * sizeof(int)); p += h.L * sizeof(int);
+		std::memcpy(fromL.data(), p, n * sizeof(Weight));     p += n * sizeof(Weight);
+		std::memcpy(toL.data(), p, n * sizeof(Weight));
+		return true;
+	}
+
+	typedef QueryWorkspace<Weight> Workspace;
+
+	/**
+	 * @brief Recherche un plus court chemin de s a t par A*
+	 * @param s, sommet de depart
+	 * @param t, sommet d'arrivee
+	 * @return le chemin trouve
+	 */
+	Route<Edge> Query(int s, int t) const {
+		Workspace workspace;
+		return Query(s, t, workspace);
+	}
+
+	/**
+	 * @brief Recherche un plus court chemin de s a t en reutilisant
+	 *        workspace. Seule la recherche avant est utilisee.
+	 * @param workspace, espace de travail propre au thread appelant
+	 * @param closed, sommet a eviter (gare fermee), -1 pour aucun. Fermer
+	 *        un sommet ne fait qu'allonger les distances: les bornes des
+	 *        reperes restent admissibles et les tables restent valables.
+	 */
+	Route<Edge> Query(int s, int t, Workspace& workspace, int closed = -1) const {
+		Route<Edge> route;
+		if(s == closed || t == closed) return route;
+
+		SearchSpace<Weight>& space = workspace.forward;
+		IndexMinPQ<Weight>& pq = space.Queue();
+		space.Reset(forward.V());
+		space.Set(s, 0, -1);
+		pq.Push(s, lowerBound(s, t));
+
+		const int* offsets = forward.Offsets();
+		const int* targets = forward.Targets();
+		const Weight* weights = forward.Weights();
+		while(!pq.Empty()) {
+			int u = pq.Pop();
+			++route.settled;
+			if(u == t) break;
+
+			Weight du = space.Distance(u);
+			for(int i = offsets[u]; i < offsets[u+1]; ++i) {
+				int w = targets[i];
+				if(w == closed) continue;
+				Weight d = du + weights[i];
+				if(d < space.Distance(w) && !space.Settled(w)) {
+					space.Set(w, d, u, weights[i]);
+					pq.PushOrDecrease(w, d + lowerBound(w, t));
+				}
+			}
+		}
+
+		if(!space.Settled(t)) return route;
+
+		route.found = true;
+		route.distance = space.Distance(t);
+		for(int v = t; space.Parent(v) >= 0; v = space.Parent(v))
+			route.path.push_back(Edge(space.Parent(v), v, space.ParentWeight(v)));
+		std::reverse(route.path.begin(), route.path.end());
+		return route;
+	}
+};
+
+// Tables ALT du reseau ferroviaire pour les deux criteres de recherche de
+// chemin: la longueur et la duree des lignes. Les tables sont sauvegardees
+// dans networkFile.length.alt et networkFile.duration.alt.
+
+class TrainALT {
+private:
+	CachedTrainDiGraphWrapper lengthGraph;
+	CachedTrainDiGraphWrapper durationGraph;
+
+public:
+	ALTSP<CachedTrainDiGraphWrapper> Length;
+	ALTSP<CachedTrainDiGraphWrapper> Duration;
+
+	/**
+	 * @brief Constructeur
+	 * @param tn, reseau de trains et de lignes
+	 * @param networkFile, nom du fichier du reseau (reseau.txt)
+	 * @param nbLandmarks, nombre de reperes
+	 */
+	TrainALT(const TrainNetwork& tn, const std::string& networkFile, int nbLandmarks = 4)
+		: lengthGraph(tn, [](const TrainNetwork::Line& l) { return l.length; }),
+		  durationGraph(tn, [](const TrainNetwork::Line& l) { return l.duration; }),
+		  Length(lengthGraph, networkFile + ".length.alt", nbLandmarks),
+		  Duration(durationGraph, networkFile + ".duration.alt", nbLandmarks)
+	{
+	}
+};
+
+#endif
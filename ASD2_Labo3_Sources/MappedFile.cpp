@@ -0,0 +1,64 @@
+/*
+ * @file   MappedFile.cpp
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#include "MappedFile.h"
+
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ASD2_HAS_MMAP 1
+#endif
+
+MappedFile::MappedFile(const std::string& filename)
+	: data(nullptr), size(0), mapped(false)
+{
+#ifdef ASD2_HAS_MMAP
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if(fd >= 0) {
+		struct stat st;
+		if(::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+			size = size_t(st.st_size);
+			if(size == 0) {
+				::close(fd);
+				data = "";
+				return;
+			}
+			void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(p != MAP_FAILED) {
+				::madvise(p, size, MADV_SEQUENTIAL);
+				::close(fd);
+				data = static_cast<const char*>(p);
+				mapped = true;
+				return;
+			}
+		}
+		::close(fd);
+	}
+#endif
+
+	// repli: lecture complete du fichier avec ifstream
+	std::ifstream s(filename, std::ios::binary);
+	if(!s)
+		throw std::runtime_error("MappedFile: impossible d'ouvrir " + filename);
+	buffer.assign(std::istreambuf_iterator<char>(s), std::istreambuf_iterator<char>());
+	data = buffer.data();
+	size = buffer.size();
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef ASD2_HAS_MMAP
+	if(mapped)
+		::munmap(const_cast<char*>(data), size);
+#endif
+}
@@ -0,0 +1,50 @@
+/*
+ * @file   MappedFile.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_MappedFile_h
+#define ASD2_MappedFile_h
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Fichier ouvert en lecture seule et projete en memoire (mmap). Le contenu
+// est accessible directement par Data()/Size() sans copie. Si la projection
+// n'est pas possible (systeme non POSIX, fichier special, ...), le fichier
+// est lu avec std::ifstream dans un tampon interne.
+
+class MappedFile {
+private:
+	const char* data;
+	size_t size;
+	bool mapped;                 // vrai si data provient de mmap
+	std::vector<char> buffer;    // contenu lu par ifstream si mapped est faux
+
+public:
+	/**
+	 * @brief Ouvre et projette le fichier filename
+	 * @throw std::runtime_error si le fichier ne peut pas etre lu
+	 */
+	explicit MappedFile(const std::string& filename);
+
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Debut du contenu du fichier
+	const char* Data() const { return data; }
+
+	// Taille du fichier en octets
+	size_t Size() const { return size; }
+
+	// Indique si le contenu est projete en memoire ou copie dans un tampon
+	bool IsMapped() const { return mapped; }
+};
+
+#endif
@@ -10,10 +10,14 @@
 
 #include <queue>
 #include <vector>
-#include <set>
 #include <functional>
+#include <atomic>
+#include <algorithm>
 
 #include "UnionFind.h"
+#include "ThreadPool.h"
+#include "IndexMinPQ.h"
+#include "Instrumentation.h"
 
 // Classe définissant les difféents algorithmes de calcul de l'arbre
 // couvrant de poids minimum sous forme de methodes statiques.
@@ -36,35 +40,234 @@ public:
 private:
 	// Type queue de priorite. MinPQ::top() retourne l'élément le plus petit.
 	typedef std::priority_queue<Edge,std::vector<Edge>,std::greater<Edge>> MinPQ;
+
+	typedef typename EdgeList::iterator EdgeIterator;
+
+	// Etat de Filter-Kruskal
+	struct FilterState {
+		size_t V;
+		CompactUnionFind uf;
+		EdgeList output;
+		ThreadPool* pool;
+
+		FilterState(int _V, ThreadPool* _pool) : V(_V), uf(_V), pool(_pool) { }
+
+		bool done() const { return output.size() + 1 >= V; }
+	};
+
+	// Kruskal sur les aretes de [begin,end) apres les avoir triees
+	static void kruskalSorted(EdgeIterator begin, EdgeIterator end, FilterState& s) {
+		if(s.pool)
+			s.pool->ParallelSort(begin, end, std::less<Edge>());
+		else
+			std::sort(begin, end);
+		for(EdgeIterator it = begin; it != end && !s.done(); ++it) {
+			int v = it->Either(), w = it->Other(v);
+			if(s.uf.Unite(v, w))
+				s.output.push_back(*it);
+		}
+	}
+
+	static void filterKruskal(EdgeIterator begin, EdgeIterator end, FilterState& s) {
+		size_t n = size_t(end - begin);
+		if(s.done() || n == 0) return;
+		if(n <= std::max<size_t>(1024, s.V)) {
+			kruskalSorted(begin, end, s);
+			return;
+		}
+
+		// pivot: mediane de trois poids
+		Edge a = *begin, b = *(begin + n/2), c = *(end - 1);
+		Edge pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+		EdgeIterator mid = std::partition(begin, end, [&pivot](const Edge& e) { return e < pivot; });
+		if(mid == begin)
+			mid = std::partition(begin, end, [&pivot](const Edge& e) { return !(pivot < e); });
+		if(mid == end) {           // tous les poids sont egaux
+			kruskalSorted(begin, end, s);
+			return;
+		}
+
+		filterKruskal(begin, mid, s);
+		if(s.done()) return;
+		EdgeIterator kept = std::partition(mid, end, [&s](const Edge& e) {
+			int v = e.Either();
+			return !s.uf.Connected(v, e.Other(v));
+		});
+		filterKruskal(mid, kept, s);
+	}
+
+	static EdgeList filterKruskal(const GraphType& g, ThreadPool* pool) {
+		EdgeList edges;
+		g.forEachEdge([&edges](const Edge& e) { edges.push_back(e); });
+
+		FilterState s(g.V(), pool);
+		s.output.reserve(g.V() > 0 ? g.V()-1 : 0);
+		filterKruskal(edges.begin(), edges.end(), s);
+		return s.output;
+	}
 	
 public:
 	// Algorithme de Kruskal.
 	
 	static EdgeList Kruskal(const GraphType& g) {
+		NoInstrumentation instrumentation;
+		return Kruskal(g, instrumentation);
+	}
+
+	// Kruskal instrumente, voir Instrumentation.h. Scan compte les aretes
+	// sorties de la queue, Settle celles acceptees dans l'arbre.
+
+	template<typename Instrumentation>
+	static EdgeList Kruskal(const GraphType& g, Instrumentation& instrumentation) {
 		
+		auto timer = instrumentation.Start();
 		EdgeList output; output.reserve(g.V()-1);
 		MinPQ pq;
+		CompactUnionFind uf(g.V());
+		instrumentation.Stop(Phase::Setup, timer);
 		
+		timer = instrumentation.Start();
 		g.forEachEdge([&pq](const Edge& e) {   // trie de toutes les aretes en les mettant
 											   // dans la queue de priorite
 			pq.push(e);
 		});
+		instrumentation.Stop(Phase::Sort, timer);
 		
-		UnionFind uf(g.V());
-		
+		timer = instrumentation.Start();
 		while ( !pq.empty() && output.size() < g.V()-1 ) {
 			Edge e = pq.top(); pq.pop();
 			int v = e.Either(), w = e.Other(v);
-			if( !uf.Connected(v,w) )
-			{
-				uf.Union(v, w);
+			instrumentation.Scan();
+			bool merged;
+			if constexpr (Instrumentation::Enabled) {
+				// on compte les recherches faites par Unite elle-meme
+				int stepsV, stepsW;
+				merged = uf.Unite(v, w, stepsV, stepsW);
+				instrumentation.Find(stepsV);
+				instrumentation.Find(stepsW);
+			} else
+				merged = uf.Unite(v, w);
+			if( merged ) {
 				output.push_back(e);
+				instrumentation.Settle();
 			}
 		}
+		instrumentation.Stop(Phase::Search, timer);
 		
 		return output;
 	}
 	
+	// Algorithme Filter-Kruskal (Osipov, Sanders et Singler). Les aretes
+	// sont partitionnees autour d'un pivot comme dans quicksort. On traite
+	// d'abord les aretes legeres, puis on retire des aretes lourdes celles
+	// dont les extremites sont deja reliees avant de les traiter a leur
+	// tour. Les petits ensembles d'aretes sont tries puis parcourus comme
+	// dans Kruskal. Sur un graphe peu dense, la plupart des aretes lourdes
+	// sont filtrees sans jamais etre triees.
+	//
+	// Avec un ThreadPool, les tris sont faits par ThreadPool::ParallelSort.
+
+	static EdgeList FilterKruskal(const GraphType& g) {
+		return filterKruskal(g, nullptr);
+	}
+
+	static EdgeList FilterKruskal(const GraphType& g, ThreadPool& pool) {
+		return filterKruskal(g, &pool);
+	}
+
+	// Algorithme de Boruvka parallele. A chaque tour, chaque composante
+	// choisit l'arete la plus legere qui la quitte, puis les composantes
+	// sont fusionnees le long des aretes choisies. Le nombre de composantes
+	// est au moins divise par deux a chaque tour, il y a donc au plus
+	// log2(V) tours.
+	//
+	// Le choix des aretes est parallele: les threads se partagent les
+	// aretes et mettent a jour la meilleure arete de chaque composante par
+	// compare-and-swap, puis les composantes sont fusionnees en parallele
+	// dans un ConcurrentUnionFind. Les aretes sont ordonnees par poids puis
+	// par indice dans l'ordre de forEachEdge: l'arbre obtenu est unique et
+	// ne depend pas du nombre de threads. Les aretes internes a une
+	// composante sont retirees au fur et a mesure. Si le graphe n'est pas
+	// connexe, le resultat est une foret couvrante.
+
+	static EdgeList Boruvka(const GraphType& g, ThreadPool& pool) {
+		int V = g.V();
+		EdgeList edges;
+		g.forEachEdge([&edges](const Edge& e) { edges.push_back(e); });
+
+		auto lighter = [&edges](int a, int b) {
+			return edges[a].Weight() < edges[b].Weight()
+			    || (!(edges[b].Weight() < edges[a].Weight()) && a < b);
+		};
+
+		EdgeList output; output.reserve(V > 0 ? V-1 : 0);
+		ConcurrentUnionFind uf(V);
+		std::vector<int> comp(V);                   // composante de chaque sommet
+		std::vector<char> accepted(V);              // l'arete choisie par la composante a ete ajoutee
+		std::vector<std::atomic<int>> best(V);      // arete choisie par chaque composante, -1 sinon
+		std::vector<int> alive(edges.size());       // aretes pouvant encore relier deux composantes
+		for(int e = 0; e < int(alive.size()); ++e) alive[e] = e;
+
+		int T = int(pool.Size());
+		std::vector<std::vector<int>> kept(T);
+
+		while(!alive.empty()) {
+			pool.ParallelFor(0, V, [&](int lo, int hi) {
+				for(int v = lo; v < hi; ++v) {
+					comp[v] = uf.Find(v);
+					best[v].store(-1, std::memory_order_relaxed);
+				}
+			});
+
+			int n = int(alive.size());
+			pool.ParallelTasks(T, [&](int t) {
+				kept[t].clear();
+				for(int k = int(long(n) * t / T); k < int(long(n) * (t+1) / T); ++k) {
+					int e = alive[k];
+					int v = edges[e].Either();
+					int cv = comp[v], cw = comp[edges[e].Other(v)];
+					if(cv == cw) continue;
+					kept[t].push_back(e);
+					for(int c : { cv, cw }) {
+						int cur = best[c].load(std::memory_order_relaxed);
+						while((cur < 0 || lighter(e, cur))
+						      && !best[c].compare_exchange_weak(cur, e, std::memory_order_relaxed)) { }
+					}
+				}
+			});
+
+			alive.clear();
+			for(const std::vector<int>& list : kept)
+				alive.insert(alive.end(), list.begin(), list.end());
+
+			// fusion parallele des composantes. Une arete choisie par ses deux
+			// composantes n'est ajoutee qu'une fois, par l'appel a Unite qui reussit.
+			pool.ParallelFor(0, V, [&](int lo, int hi) {
+				for(int c = lo; c < hi; ++c) {
+					int e = best[c].load(std::memory_order_relaxed);
+					accepted[c] = e >= 0 && uf.Unite(edges[e].Either(), edges[e].Other(edges[e].Either()));
+				}
+			});
+			// les representants dependent de l'ordre des unions, on range donc
+			// les aretes du tour par indice
+			std::vector<int> chosen;
+			for(int c = 0; c < V; ++c)
+				if(accepted[c])
+					chosen.push_back(best[c].load(std::memory_order_relaxed));
+			std::sort(chosen.begin(), chosen.end());
+			for(int e : chosen)
+				output.push_back(edges[e]);
+		}
+		return output;
+	}
+
+	// Algorithme de Boruvka parallele sur tous les coeurs de la machine
+
+	static EdgeList Boruvka(const GraphType& g) {
+		ThreadPool pool;
+		return Boruvka(g, pool);
+	}
+
 	/* Fera l'objet d'un exercice de programmation
 	// Algorithme de Prim en version paresseuse. Utilise une queue de priorite
 	// pour les aretes a traiter.
@@ -77,48 +280,59 @@ public:
 	*/
 	
 	// Algorithme de Prim en version stricte. Utilise une queue de priorite
-	// pour les sommets a traiter. Celle ci est mise en oeuvre avec std::set.
-	
+	// indexee (tas D-aire) pour les sommets a traiter: la cle d'un sommet est
+	// le poids de l'arete la plus legere le reliant a l'arbre courant, puis
+	// son numero pour departager les egalites. La recherche repart de chaque
+	// sommet non atteint, le resultat est donc une foret couvrante si le
+	// graphe n'est pas connexe.
+
+	template<int D = 4>   // arite du tas
 	static EdgeList EagerPrim(const GraphType& g) {
-		
-		EdgeList output; output.reserve(g.V()-1);
-		
-		typedef std::pair<Edge,int> EdgeVertex;     // paire arc/sommet.
-													// operator< s'applique sur le premier
-													// element de la paire, puis le deuxieme
-													// si egalite.
-		
-		std::set<EdgeVertex> pq;                    // queue de priorite
-		std::vector<Edge> edge(g.V());              // arc le plus leger pour joindre chaque sommet
+		NoInstrumentation instrumentation;
+		return EagerPrim<D>(g, instrumentation);
+	}
+
+	// Prim instrumente, voir Instrumentation.h
+
+	template<int D, typename Instrumentation>
+	static EdgeList EagerPrim(const GraphType& g, Instrumentation& instrumentation) {
+		typedef typename Edge::WeightType Weight;
+		auto timer = instrumentation.Start();
+		int V = g.V();
+
+		EdgeList output; output.reserve(V > 0 ? V-1 : 0);
+
+		std::vector<Edge> edge(V);                  // arc le plus leger pour joindre chaque sommet
 													// a l'arbre courrant.
-		std::vector<bool> marked(g.V(),false);
-		
-		marked[0] = true;
-		g.forEachAdjacentEdge(0,[&](const Edge& e) {
-			int w = e.Other(0);
-			edge[w] = e;
-			pq.insert(std::make_pair(e,w)); // set::insert() correspond à priority_queue::push().
-		});
-		
-		while ( !pq.empty() && output.size() < g.V()-1 ) {
-			
-			Edge e = pq.begin()->first;     // set::begin() correspond à priority_queue::top().
-			output.push_back(e);
-			
-			int v = pq.begin()->second;
-			marked[v] = true;
-			
-			pq.erase(pq.begin());            // correspond à priority_queue::pop().
+		std::vector<char> marked(V, 0);
+		IndexMinPQ<std::pair<Weight,int>, D> pq(V);
 
+		auto visit = [&](int v) {
+			marked[v] = 1;
+			instrumentation.Settle();
 			g.forEachAdjacentEdge(v,[&](const Edge& e) {
 				int w = e.Other(v);
-				if(!marked[w] && edge[w] > e) {
-					pq.erase(std::make_pair(edge[w],w));    // deux operations pour decrease_key
-					pq.insert(std::make_pair(e,w));
+				instrumentation.Scan();
+				if(!marked[w] && (!pq.Contains(w) || e.Weight() < edge[w].Weight())) {
 					edge[w] = e;
+					instrumentation.Relax();
+					instrumentation.Enqueue(pq.PushOrDecrease(w, std::make_pair(e.Weight(), w)), pq.Size());
 				}
 			});
+		};
+		instrumentation.Stop(Phase::Setup, timer);
+
+		timer = instrumentation.Start();
+		for(int root = 0; root < V; ++root) {
+			if(marked[root]) continue;
+			visit(root);
+			while(!pq.Empty()) {
+				int v = pq.Pop();
+				output.push_back(edge[v]);
+				visit(v);
+			}
 		}
+		instrumentation.Stop(Phase::Search, timer);
 		return output;
 	}
 };
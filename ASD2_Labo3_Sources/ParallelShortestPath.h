@@ -0,0 +1,344 @@
+/*
+ * @file   ParallelShortestPath.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_ParallelShortestPath_h
+#define ASD2_ParallelShortestPath_h
+
+#include <vector>
+#include <limits>
+
+#include "ShortestPath.h"
+#include "ThreadPool.h"
+
+// Algorithme de BellmanFord parallele.
+//
+// Chaque passe est calculee a la Jacobi: la nouvelle distance de w est le
+// minimum, sur les arcs u->w entrants, de l'ancienne distance de u plus le
+// poids de l'arc. Les distances de la passe precedente ne sont que lues et
+// chaque thread n'ecrit que les sommets de son intervalle, il n'y a donc
+// aucune synchronisation dans une passe et le resultat est deterministe,
+// independant du nombre de threads.
+//
+// Les intervalles de sommets sont choisis pour avoir a peu pres le meme
+// nombre d'arcs entrants chacun. Le calcul s'arrete des qu'une passe ne
+// modifie plus aucune distance. Si la passe V modifie encore une distance,
+// un cycle de poids negatif est atteignable depuis la source.
+
+template<typename GraphType> // Type du graphe pondere oriente a traiter
+							 // GraphType doit se comporter comme un
+							 // EdgeWeightedDiGraph et definir V() et forEachEdge(Func),
+							 // ainsi que le type GraphType::Edge.
+class ParallelBellmanFordSP : public ShortestPath<GraphType> {
+
+private:
+	typedef ShortestPath<GraphType> BASE;
+	typedef typename BASE::Edge Edge;
+	typedef typename BASE::Weight Weight;
+
+	bool negativeCycle;
+
+public:
+	/**
+	 * @brief Constructeur a partir du graphe g et du sommet v a la source des plus courts chemins
+	 * @param g, graphe dans lequel on veut construire
+	 * @param v, sommet é partir duquel on veut construire
+	 * @param pool, threads a utiliser
+	 */
+	ParallelBellmanFordSP(const GraphType& g, int v, ThreadPool& pool) : negativeCycle(false) {
+		const Weight INF = std::numeric_limits<Weight>::max();
+		int V = g.V();
+
+		// arcs entrants de chaque sommet, au format CSR
+		std::vector<int> offsets(V+1, 0);
+		g.forEachEdge([&](const Edge& e) { ++offsets[e.To()+1]; });
+		for(int w = 0; w < V; ++w)
+			offsets[w+1] += offsets[w];
+		std::vector<Edge> inEdges(offsets[V]);
+		{
+			std::vector<int> next(offsets.begin(), offsets.end()-1);
+			g.forEachEdge([&](const Edge& e) { inEdges[next[e.To()]++] = e; });
+		}
+
+		// intervalles de sommets de charge equilibree
+		int nbChunks = int(pool.Size()) * 4;
+		std::vector<int> bounds(1, 0);
+		for(int c = 1; c < nbChunks; ++c) {
+			long target = long(offsets[V]) * c / nbChunks;
+			int w = bounds.back();
+			while(w < V && offsets[w] < target) ++w;
+			bounds.push_back(w);
+		}
+		bounds.push_back(V);
+
+		this->edgeTo.resize(V);
+		this->distanceTo.assign(V, INF);
+		this->edgeTo[v] = Edge(v,v,0);
+		this->distanceTo[v] = 0;
+
+		std::vector<Weight> next(this->distanceTo);
+		std::vector<char> changed(bounds.size() - 1);
+
+		bool anyChange = true;
+		for(int round = 0; round < V && anyChange; ++round) {
+			const std::vector<Weight>& cur = this->distanceTo;
+
+			pool.ParallelTasks(int(bounds.size()) - 1, [&](int c) {
+				bool localChange = false;
+				for(int w = bounds[c]; w < bounds[c+1]; ++w) {
+					Weight best = cur[w];
+					int bestEdge = -1;
+					for(int i = offsets[w]; i < offsets[w+1]; ++i) {
+						Weight du = cur[inEdges[i].From()];
+						if(du == INF) continue;
+						Weight d = du + inEdges[i].Weight();
+						if(d < best) { best = d; bestEdge = i; }
+					}
+					next[w] = best;
+					if(bestEdge >= 0) {
+						this->edgeTo[w] = inEdges[bestEdge];
+						localChange = true;
+					}
+				}
+				changed[c] = localChange;
+			});
+
+			this->distanceTo.swap(next);
+			anyChange = false;
+			for(char c : changed) anyChange = anyChange || c;
+			negativeCycle = anyChange && round == V - 1;
+		}
+	}
+
+	/**
+	 * @brief Indique si un cycle de poids negatif est atteignable depuis la source.
+	 *        Dans ce cas les distances calculees n'ont pas de sens.
+	 */
+	bool HasNegativeCycle() const {
+		return negativeCycle;
+	}
+
+	/**
+	 * @brief Comme ShortestPath::PathTo, mais vide si un cycle de poids
+	 *        negatif a ete trouve
+	 */
+	typename BASE::Edges PathTo(int v) const {
+		return HasNegativeCycle() ? typename BASE::Edges() : BASE::PathTo(v);
+	}
+};
+
+// Algorithme delta-stepping (Meyer et Sanders). Les sommets a traiter sont
+// ranges dans des seaux de largeur delta selon leur distance provisoire: le
+// seau i contient les sommets de distance dans [i*delta, (i+1)*delta). Les
+// seaux sont traites dans l'ordre. Les arcs legers (poids <= delta) des
+// sommets du seau courant sont relaches jusqu'a ce que le seau soit vide,
+// puis les arcs lourds des sommets qui y sont passes une fois pour toutes.
+//
+// Chaque phase est parallele: les threads generent les demandes de
+// relachement pour une partie des sommets du seau, reparties selon le
+// sommet d'arrivee, puis chaque thread applique les demandes concernant ses
+// sommets. Le resultat ne depend pas du nombre de threads: les ensembles de
+// sommets de chaque phase sont les memes quel que soit T, seul leur ordre
+// change, et entre deux arcs donnant la meme distance on garde celui dont
+// l'origine est la plus petite. Les poids doivent etre positifs ou nuls.
+//
+// Un delta tres petit se rapproche de Dijkstra (un sommet par seau ou
+// presque, peu de parallelisme), un delta tres grand de Bellman-Ford
+// (beaucoup de relachements inutiles). DefaultDelta donne une valeur
+// intermediaire calculee a partir des poids du graphe.
+
+template<typename GraphType> // Type du graphe pondere oriente a traiter
+							 // GraphType doit se comporter comme un
+							 // EdgeWeightedDiGraph et definir V(), forEachVertex(Func)
+							 // et forEachAdjacentEdge(int,Func), ainsi que le type GraphType::Edge.
+class DeltaSteppingSP : public ShortestPath<GraphType> {
+
+public:
+	typedef ShortestPath<GraphType> BASE;
+	typedef typename BASE::Edge Edge;
+	typedef typename BASE::Weight Weight;
+
+private:
+	// demande de relachement: distance d pour e.To() par l'arc e
+	struct Request {
+		Weight d;
+		Edge e;
+	};
+
+	// requests[t][s]: demandes generees par le thread t pour les sommets du thread s
+	typedef std::vector<std::vector<std::vector<Request>>> Requests;
+
+	Weight delta;
+
+	// Seaux cycliques: le seau i est range dans buckets[i % buckets.size()].
+	// Un relachement depuis le seau i atteint au plus le seau
+	// i + 1 + poids maximal / delta, il suffit donc d'autant de cases plus
+	// une. Une case peut contenir des sommets d'un seau ulterieur, qui sont
+	// laisses en place, et des sommets dont la distance a diminue depuis,
+	// qui sont ignores.
+	std::vector<std::vector<int>> buckets;
+	size_t pending = 0;                          // entrees dans l'ensemble des seaux
+
+	size_t bucketOf(Weight d) const {
+		return size_t(d / delta);
+	}
+
+	void insert(int w, Weight d) {
+		buckets[bucketOf(d) % buckets.size()].push_back(w);
+		++pending;
+	}
+
+	/**
+	 * @brief Relache en parallele les arcs des sommets de vertices dont le
+	 *        poids est leger (light vrai) ou lourd (light faux). requests et
+	 *        improved sont reutilises d'une phase a l'autre.
+	 */
+	void relaxAll(const GraphType& g, const std::vector<int>& vertices, bool light, ThreadPool& pool,
+	              Requests& requests, std::vector<std::vector<int>>& improved) {
+		int T = int(requests.size());
+		int V = g.V();
+		int n = int(vertices.size());
+		auto owner = [T,V](int w) { return int(long(w) * T / V); };
+
+		pool.ParallelTasks(T, [&](int t) {
+			for(std::vector<Request>& list : requests[t]) list.clear();
+			for(int k = int(long(n) * t / T); k < int(long(n) * (t+1) / T); ++k) {
+				int v = vertices[k];
+				Weight dv = this->distanceTo[v];
+				g.forEachAdjacentEdge(v, [&](const Edge& e) {
+					if(e.From() != v || (e.Weight() <= delta) != light) return;
+					Weight d = dv + e.Weight();
+					if(d <= this->distanceTo[e.To()])     // egalite: voir apply
+						requests[t][owner(e.To())].push_back(Request{d, e});
+				});
+			}
+		});
+
+		// application des demandes, chaque thread pour ses sommets. A
+		// distance egale, l'arc d'origine la plus petite l'emporte, sauf
+		// pour la source qui garde son arc v->v.
+		pool.ParallelTasks(T, [&](int s) {
+			improved[s].clear();
+			for(int t = 0; t < T; ++t)
+				for(const Request& r : requests[t][s]) {
+					int w = r.e.To();
+					if(r.d < this->distanceTo[w]) {
+						this->distanceTo[w] = r.d;
+						this->edgeTo[w] = r.e;
+						improved[s].push_back(w);
+					} else if(r.d == this->distanceTo[w] && this->edgeTo[w].From() != w
+					          && r.e.From() < this->edgeTo[w].From())
+						this->edgeTo[w] = r.e;
+				}
+		});
+
+		for(const std::vector<int>& list : improved)
+			for(int w : list)
+				insert(w, this->distanceTo[w]);
+	}
+
+public:
+	/**
+	 * @brief Valeur de delta par defaut: le poids maximal divise par le degre
+	 *        sortant moyen, ce qui donne en moyenne une poignee d'arcs legers
+	 *        par sommet (Meyer et Sanders proposent delta = 1/d pour des poids
+	 *        uniformes dans [0,1]).
+	 */
+	static Weight DefaultDelta(const GraphType& g) {
+		Weight maxWeight = 0;
+		long E = 0;
+		g.forEachVertex([&](int v) {
+			g.forEachAdjacentEdge(v, [&](const Edge& e) {
+				if(e.From() != v) return;
+				++E;
+				if(e.Weight() > maxWeight) maxWeight = e.Weight();
+			});
+		});
+		double avgDegree = g.V() ? double(E) / g.V() : 0;
+		Weight d = avgDegree > 1 ? Weight(maxWeight / avgDegree) : maxWeight;
+		return d > 0 ? d : Weight(1);
+	}
+
+	/**
+	 * @brief Constructeur a partir du graphe g et du sommet v a la source des plus courts chemins
+	 * @param g, graphe dans lequel on veut construire
+	 * @param v, sommet é partir duquel on veut construire
+	 * @param pool, threads a utiliser
+	 * @param _delta, largeur des seaux. 0 pour DefaultDelta(g)
+	 */
+	DeltaSteppingSP(const GraphType& g, int v, ThreadPool& pool, Weight _delta = 0)
+		: delta(_delta > 0 ? _delta : DefaultDelta(g))
+	{
+		int V = g.V();
+		this->edgeTo.resize(V);
+		this->distanceTo.assign(V, std::numeric_limits<Weight>::max());
+		this->edgeTo[v] = Edge(v,v,0);
+		this->distanceTo[v] = 0;
+
+		Weight maxWeight = 0;
+		g.forEachVertex([&](int u) {
+			g.forEachAdjacentEdge(u, [&](const Edge& e) {
+				if(e.From() == u && e.Weight() > maxWeight) maxWeight = e.Weight();
+			});
+		});
+		// un seau de plus que le strict necessaire absorbe les arrondis, et
+		// la limite a V garde un nombre de cases raisonnable pour un delta
+		// minuscule: les seaux ulterieurs restent alors dans leur case
+		double slots = std::min(double(maxWeight / delta), double(V));
+		buckets.resize(size_t(slots) + 2);
+		insert(v, 0);
+
+		int T = int(pool.Size());
+		Requests requests(T, std::vector<std::vector<Request>>(T));
+		std::vector<std::vector<int>> improved(T);
+
+		std::vector<size_t> seen(V, size_t(-1));     // dernier seau ou le sommet a ete traite
+		std::vector<size_t> inFrontier(V, 0);        // numero de la derniere frontiere du sommet
+		size_t frontierId = 0;
+		std::vector<int> settled, frontier, current, later;
+
+		for(size_t i = 0; pending > 0; ++i) {
+			std::vector<int>& bucket = buckets[i % buckets.size()];
+			if(bucket.empty()) continue;
+			settled.clear();                         // sommets passes par le seau i
+			later.clear();                           // sommets de seaux ulterieurs
+
+			while(!bucket.empty()) {
+				frontier.clear();
+				++frontierId;
+				current.swap(bucket);
+				pending -= current.size();
+				for(int w : current) {
+					size_t b = bucketOf(this->distanceTo[w]);
+					if(b > i)
+						later.push_back(w);
+					else if(b == i && inFrontier[w] != frontierId) {
+						inFrontier[w] = frontierId;
+						frontier.push_back(w);
+						if(seen[w] != i) {
+							seen[w] = i;
+							settled.push_back(w);
+						}
+					}
+				}
+				current.clear();
+
+				relaxAll(g, frontier, true, pool, requests, improved);
+			}
+
+			relaxAll(g, settled, false, pool, requests, improved);
+
+			bucket.insert(bucket.end(), later.begin(), later.end());
+			pending += later.size();
+		}
+	}
+
+	// Largeur des seaux utilisee
+	Weight Delta() const { return delta; }
+};
+
+#endif
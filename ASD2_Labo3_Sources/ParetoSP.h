@@ -0,0 +1,199 @@
+/*
+ * @file   ParetoSP.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_ParetoSP_h
+#define ASD2_ParetoSP_h
+
+#include <array>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <limits>
+#include <functional>
+
+#include "TrainNetwork.h"
+#include "EdgeWeightedDiGraph.h"
+
+// Recherche multicritere de chemins dans le reseau de trains (algorithme de
+// Martins). Chaque ligne a K poids, par exemple (longueur, duree, cout). Un
+// chemin en domine un autre s'il est au moins aussi bon sur tous les
+// criteres. La recherche renvoie le front de Pareto: tous les chemins de s a
+// t qui ne sont domines par aucun autre, en une seule recherche.
+//
+// Chaque sommet garde un ensemble d'etiquettes (vecteur de poids d'un chemin
+// depuis s) non dominees entre elles. Les etiquettes sont traitees dans
+// l'ordre lexicographique de leurs poids: une etiquette qui sort de la queue
+// ne peut plus etre dominee, elle est definitive. Une nouvelle etiquette est
+// ignoree si elle est dominee par une etiquette du sommet ou de t (les poids
+// etant positifs, ses prolongements le seraient aussi), et elle elimine les
+// etiquettes du sommet qu'elle domine.
+//
+// Le front peut etre tres grand. maxLabels borne le nombre d'etiquettes par
+// sommet: au-dela, les nouvelles etiquettes sont ignorees et le front renvoye
+// n'est plus forcement complet.
+
+template<int K> // nombre de criteres
+class ParetoSP {
+public:
+	typedef int Weight;
+	typedef std::array<Weight,K> Costs;
+	// Arc d'un chemin, pondere par le premier critere
+	typedef WeightedDirectedEdge<Weight> Edge;
+
+	// Un chemin du front de Pareto
+	struct ParetoRoute {
+		Costs costs;                // poids du chemin pour chaque critere
+		std::vector<Edge> path;     // arcs du chemin, dans l'ordre de s a t
+		std::vector<int> lines;     // indices des lignes dans TrainNetwork::lines
+	};
+
+private:
+	// liste d'adjacence CSR: arcs offsets[v]..offsets[v+1]-1 partant de v
+	std::vector<int> offsets;
+	std::vector<int> targets;
+	std::vector<int> lineIds;
+	std::vector<Costs> costs;
+	int maxLabels;
+
+	struct Label {
+		Costs c;
+		int vertex;
+		int parent;     // etiquette precedente, -1 pour s
+		int arc;        // arc parent->vertex
+		bool dead;      // eliminee par une etiquette qui la domine
+	};
+
+	static bool dominates(const Costs& a, const Costs& b) {
+		for(int i = 0; i < K; ++i)
+			if(a[i] > b[i]) return false;
+		return true;
+	}
+
+	static bool dominatedBy(const Costs& c, const std::vector<int>& bag, const std::vector<Label>& labels) {
+		for(int l : bag)
+			if(dominates(labels[l].c, c)) return true;
+		return false;
+	}
+
+public:
+	/**
+	 * @brief Constructeur
+	 * @param tn, reseau de trains et de lignes
+	 * @param fnCosts, fonction convertissant un TrainNetwork::Line en Costs.
+	 *        Une ligne dont un poids vaut numeric_limits<Weight>::max() est
+	 *        consideree comme fermee.
+	 * @param _maxLabels, nombre maximal d'etiquettes par sommet, 0 pour
+	 *        ne pas borner
+	 */
+	template<typename FnCosts>
+	ParetoSP(const TrainNetwork& tn, FnCosts fnCosts, int _maxLabels = 0) : maxLabels(_maxLabels) {
+		int V = int(tn.cities.size());
+		std::vector<Costs> lineCosts(tn.lines.size());
+		std::vector<char> open(tn.lines.size(), 1);
+		for(size_t i = 0; i < tn.lines.size(); ++i) {
+			lineCosts[i] = fnCosts(tn.lines[i]);
+			for(Weight w : lineCosts[i])
+				if(w == std::numeric_limits<Weight>::max()) open[i] = 0;
+		}
+
+		offsets.assign(V+1, 0);
+		for(size_t i = 0; i < tn.lines.size(); ++i)
+			if(open[i]) {
+				++offsets[tn.lines[i].cities.first+1];
+				++offsets[tn.lines[i].cities.second+1];
+			}
+		for(int v = 0; v < V; ++v)
+			offsets[v+1] += offsets[v];
+
+		targets.resize(offsets[V]);
+		lineIds.resize(offsets[V]);
+		costs.resize(offsets[V]);
+		std::vector<int> next(offsets.begin(), offsets.end()-1);
+		for(size_t i = 0; i < tn.lines.size(); ++i)
+			if(open[i]) {
+				int a = tn.lines[i].cities.first, b = tn.lines[i].cities.second;
+				int p = next[a]++;
+				targets[p] = b; lineIds[p] = int(i); costs[p] = lineCosts[i];
+				p = next[b]++;
+				targets[p] = a; lineIds[p] = int(i); costs[p] = lineCosts[i];
+			}
+	}
+
+	/**
+	 * @brief Calcule le front de Pareto des chemins de s a t
+	 * @param s, sommet de depart
+	 * @param t, sommet d'arrivee
+	 * @return les chemins non domines, par ordre lexicographique des poids.
+	 *         Vide si t n'est pas atteignable.
+	 */
+	std::vector<ParetoRoute> Query(int s, int t) const {
+		typedef std::pair<Costs,int> Entry;
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+
+		std::vector<Label> labels;
+		std::vector<std::vector<int>> bags(offsets.size() - 1);  // etiquettes vivantes par sommet
+		std::vector<int> front;                                   // etiquettes definitives de t
+
+		labels.push_back(Label{Costs(), s, -1, -1, false});
+		bags[s].push_back(0);
+		pq.push(Entry(Costs(), 0));
+
+		while(!pq.empty()) {
+			int l = pq.top().second; pq.pop();
+			if(labels[l].dead) continue;
+			int u = labels[l].vertex;
+			if(u == t) {
+				front.push_back(l);
+				continue;
+			}
+
+			for(int i = offsets[u]; i < offsets[u+1]; ++i) {
+				int w = targets[i];
+				Costs c = labels[l].c;
+				for(int k = 0; k < K; ++k) c[k] += costs[i][k];
+
+				if(dominatedBy(c, bags[t], labels) || dominatedBy(c, bags[w], labels))
+					continue;
+
+				// elimine les etiquettes de w dominees par c
+				std::vector<int>& bag = bags[w];
+				for(size_t j = 0; j < bag.size(); )
+					if(dominates(c, labels[bag[j]].c)) {
+						labels[bag[j]].dead = true;
+						bag[j] = bag.back();
+						bag.pop_back();
+					} else
+						++j;
+				if(maxLabels > 0 && int(bag.size()) >= maxLabels)
+					continue;
+
+				int n = int(labels.size());
+				labels.push_back(Label{c, w, l, i, false});
+				bag.push_back(n);
+				pq.push(Entry(c, n));
+			}
+		}
+
+		std::vector<ParetoRoute> routes;
+		for(int l : front) {
+			ParetoRoute r;
+			r.costs = labels[l].c;
+			for(int m = l; labels[m].parent >= 0; m = labels[m].parent) {
+				int i = labels[m].arc;
+				r.path.push_back(Edge(labels[labels[m].parent].vertex, labels[m].vertex, costs[i][0]));
+				r.lines.push_back(lineIds[i]);
+			}
+			std::reverse(r.path.begin(), r.path.end());
+			std::reverse(r.lines.begin(), r.lines.end());
+			routes.push_back(r);
+		}
+		return routes;
+	}
+};
+
+#endif
@@ -0,0 +1,253 @@
+/*
+ * @file   PointToPointSP.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_PointToPointSP_h
+#define ASD2_PointToPointSP_h
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "CSRGraph.h"
+#include "IndexMinPQ.h"
+
+// Recherches de plus court chemin d'un sommet a un autre. Contrairement aux
+// classes de ShortestPath.h, qui calculent les chemins vers tous les
+// sommets, ces classes sont construites une fois pour un graphe puis
+// interrogees par Query(s,t) qui renvoie directement le chemin de s a t.
+// Query(s,t,workspace) reutilise un QueryWorkspace d'une requete a l'autre
+// pour eviter les allocations et reinitialisations en O(V).
+
+// Resultat d'une recherche de s a t
+template<typename Edge>
+struct Route {
+	typedef typename Edge::WeightType Weight;
+
+	bool found;                 // vrai si t est atteignable depuis s
+	Weight distance;            // longueur du chemin, numeric_limits<Weight>::max() sinon
+	std::vector<Edge> path;     // arcs du chemin, dans l'ordre de s a t
+	int settled;                // nombre de sommets dont la distance a ete fixee
+
+	Route() : found(false), distance(std::numeric_limits<Weight>::max()), settled(0) { }
+};
+
+// Etat d'une recherche (distances, parents et queue de priorite) reutilisable
+// d'une requete a l'autre. Au lieu de reinitialiser les tableaux en O(V) a
+// chaque requete, chaque entree porte le numero de la recherche qui l'a
+// ecrite (stamp): Reset() incremente ce numero, ce qui invalide toutes les
+// entrees d'un coup. Une requete n'ecrit ainsi que les sommets qu'elle
+// atteint, et n'alloue plus rien une fois les tableaux a la bonne taille.
+
+template<typename Weight>
+class SearchSpace {
+private:
+	std::vector<unsigned> stamp;       // recherche ayant ecrit l'entree de chaque sommet
+	unsigned generation = 0;           // numero de la recherche en cours
+	std::vector<Weight> dist;
+	std::vector<int> parent;           // sommet ou arc precedent, -1 pour la racine
+	std::vector<Weight> parentWeight;
+	IndexMinPQ<Weight> pq;
+
+public:
+	/**
+	 * @brief Commence une nouvelle recherche sur un graphe de V sommets.
+	 *        En O(1), sauf si V change ou tous les 2^32 appels.
+	 */
+	void Reset(int V) {
+		if(int(stamp.size()) != V) {
+			stamp.assign(V, 0);
+			dist.resize(V);
+			parent.resize(V);
+			parentWeight.resize(V);
+			pq.Resize(V);
+			generation = 0;
+		} else {
+			pq.Clear();
+		}
+		if(++generation == 0) {   // debordement: les anciens numeros reviendraient
+			std::fill(stamp.begin(), stamp.end(), 0);
+			generation = 1;
+		}
+	}
+
+	// Indique si v a ete atteint par la recherche en cours
+	bool Reached(int v) const { return stamp[v] == generation; }
+
+	// Indique si la distance a v est definitive (atteint et sorti de la queue)
+	bool Settled(int v) const { return Reached(v) && !pq.Contains(v); }
+
+	// Distance provisoire de la racine a v, numeric_limits<Weight>::max() si v n'est pas atteint
+	Weight Distance(int v) const {
+		return Reached(v) ? dist[v] : std::numeric_limits<Weight>::max();
+	}
+
+	// Predecesseur de v, -1 pour la racine ou si v n'est pas atteint
+	int Parent(int v) const { return Reached(v) ? parent[v] : -1; }
+
+	// Poids de l'arc Parent(v)->v
+	Weight ParentWeight(int v) const { return parentWeight[v]; }
+
+	// Met a jour la distance et le predecesseur de v
+	void Set(int v, Weight d, int p, Weight pw = Weight()) {
+		stamp[v] = generation;
+		dist[v] = d;
+		parent[v] = p;
+		parentWeight[v] = pw;
+	}
+
+	// Queue des sommets a traiter
+	IndexMinPQ<Weight>& Queue() { return pq; }
+	const IndexMinPQ<Weight>& Queue() const { return pq; }
+};
+
+// Espace de travail des requetes point a point: une recherche avant et une
+// recherche arriere. Un espace de travail ne sert qu'a une requete a la fois:
+// les graphes et pretraitements sont partages entre threads, mais chaque
+// thread doit avoir le sien.
+template<typename Weight>
+struct QueryWorkspace {
+	SearchSpace<Weight> forward;
+	SearchSpace<Weight> backward;
+};
+
+// Construit le graphe inverse de g (chaque arc v->w devient w->v)
+template<typename T>
+CSRDiGraph<T> Reverse(const CSRDiGraph<T>& g) {
+	std::vector<int> from, to;
+	std::vector<T> weight;
+	from.reserve(g.Entries()); to.reserve(g.Entries()); weight.reserve(g.Entries());
+	for(int v = 0; v < g.V(); ++v)
+		for(int i = g.Offsets()[v]; i < g.Offsets()[v+1]; ++i) {
+			from.push_back(g.Targets()[i]);
+			to.push_back(v);
+			weight.push_back(g.Weights()[i]);
+		}
+	return CSRDiGraph<T>(CSRDiGraph<T>::BuildStorage(g.V(), from, to, weight, false));
+}
+
+// Algorithme de Dijkstra bidirectionnel. Une recherche avant depuis s et une
+// recherche arriere depuis t (sur le graphe inverse) progressent en
+// alternance, en faisant avancer celle dont le prochain sommet est le plus
+// proche. best est la longueur du meilleur chemin s->t vu jusqu'ici, en
+// passant par un arc reliant les deux recherches. On s'arrete des que
+// top_avant + top_arriere >= best: aucun chemin plus court ne peut plus
+// etre trouve. Les poids doivent etre positifs ou nuls.
+
+template<typename GraphType> // Type du graphe pondere oriente a traiter
+							 // GraphType doit se comporter comme un
+							 // EdgeWeightedDiGraph et definir V() et
+							 // forEachAdjacentEdge(int,Func), ainsi que le type GraphType::Edge.
+class BidirectionalDijkstraSP {
+public:
+	typedef typename GraphType::Edge Edge;
+	typedef typename Edge::WeightType Weight;
+	typedef std::vector<Edge> Edges;
+
+private:
+	CSRDiGraph<Weight> forward;     // copie figee de g
+	CSRDiGraph<Weight> backward;    // graphe inverse
+
+	// Etat d'une des deux recherches
+	struct Search {
+		const CSRDiGraph<Weight>& g;
+		SearchSpace<Weight>& space;      // parent: sommet precedent dans la recherche
+
+		Search(const CSRDiGraph<Weight>& _g, SearchSpace<Weight>& _space, int root)
+			: g(_g), space(_space) {
+			space.Reset(g.V());
+			space.Set(root, 0, -1);
+			space.Queue().Push(root, 0);
+		}
+	};
+
+	// Fixe le prochain sommet de la recherche a et relache ses arcs.
+	// b est la recherche dans l'autre sens.
+	static void step(Search& a, const Search& b, Weight& best, int& meet, int& settled) {
+		const Weight INF = std::numeric_limits<Weight>::max();
+		int u = a.space.Queue().Pop();
+		++settled;
+		Weight du = a.space.Distance(u);
+
+		const int* offsets = a.g.Offsets();
+		const int* targets = a.g.Targets();
+		const Weight* weights = a.g.Weights();
+		for(int i = offsets[u]; i < offsets[u+1]; ++i) {
+			int w = targets[i];
+			Weight d = du + weights[i];
+			if(d < a.space.Distance(w) && !a.space.Settled(w)) {
+				a.space.Set(w, d, u, weights[i]);
+				a.space.Queue().PushOrDecrease(w, d);
+			}
+			// un meilleur chemin ne peut passer par w que si d vient d'etre
+			// attribue a la distance de w, le parent de w est donc bien u
+			Weight dw = b.space.Distance(w);
+			if(dw != INF && d + dw < best) {
+				best = d + dw;
+				meet = w;
+			}
+		}
+	}
+
+public:
+	typedef QueryWorkspace<Weight> Workspace;
+
+	/**
+	 * @brief Constructeur. Fige g et construit son graphe inverse.
+	 * @param g, graphe dans lequel on veut faire des recherches
+	 */
+	explicit BidirectionalDijkstraSP(const GraphType& g)
+		: forward(g), backward(Reverse(forward)) { }
+
+	/**
+	 * @brief Recherche un plus court chemin de s a t
+	 * @param s, sommet de depart
+	 * @param t, sommet d'arrivee
+	 * @return le chemin trouve
+	 */
+	Route<Edge> Query(int s, int t) const {
+		Workspace workspace;
+		return Query(s, t, workspace);
+	}
+
+	/**
+	 * @brief Recherche un plus court chemin de s a t en reutilisant workspace
+	 * @param workspace, espace de travail propre au thread appelant
+	 */
+	Route<Edge> Query(int s, int t, Workspace& workspace) const {
+		const Weight INF = std::numeric_limits<Weight>::max();
+		Route<Edge> route;
+
+		Search f(forward, workspace.forward, s), b(backward, workspace.backward, t);
+		IndexMinPQ<Weight>& fq = f.space.Queue();
+		IndexMinPQ<Weight>& bq = b.space.Queue();
+		Weight best = s == t ? 0 : INF;
+		int meet = s == t ? s : -1;
+
+		while(!fq.Empty() && !bq.Empty()) {
+			if(best != INF && fq.TopKey() + bq.TopKey() >= best)
+				break;
+			if(fq.TopKey() <= bq.TopKey())
+				step(f, b, best, meet, route.settled);
+			else
+				step(b, f, best, meet, route.settled);
+		}
+
+		if(meet < 0) return route;
+
+		route.found = true;
+		route.distance = best;
+		for(int v = meet; f.space.Parent(v) >= 0; v = f.space.Parent(v))
+			route.path.push_back(Edge(f.space.Parent(v), v, f.space.ParentWeight(v)));
+		std::reverse(route.path.begin(), route.path.end());
+		for(int v = meet; b.space.Parent(v) >= 0; v = b.space.Parent(v))
+			route.path.push_back(Edge(v, b.space.Parent(v), b.space.ParentWeight(v)));
+		return route;
+	}
+};
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * @file   RouteExecutor.cpp
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#include <atomic>
+#include <algorithm>
+
+#include "RouteExecutor.h"
+
+RouteExecutor::RouteExecutor(const TrainNetwork& _tn, const std::string& networkFile, int nbLandmarks)
+	: tn(_tn), alt(_tn, networkFile, nbLandmarks)
+{
+}
+
+int RouteExecutor::city(const std::string& name, std::string& error) const
+{
+	if(name.empty()) return -1;
+	auto it = tn.cityIdx.find(name);
+	if(it == tn.cityIdx.end()) {
+		if(error.empty()) error = "ville inconnue: " + name;
+		return -1;
+	}
+	return it->second;
+}
+
+RouteResult RouteExecutor::Run(const RouteRequest& request, Workspace& workspace) const
+{
+	RouteResult result;
+	int depart = city(request.depart, result.error);
+	int arrivee = city(request.arrivee, result.error);
+	int via = city(request.via, result.error);
+	int closed = city(request.closed, result.error);
+	if(depart < 0 || arrivee < 0) {
+		if(result.error.empty()) result.error = "depart et arrivee sont obligatoires";
+		return result;
+	}
+	if(!result.error.empty()) return result;
+
+	const ALTSP<CachedTrainDiGraphWrapper>& sp =
+		request.criterion == RouteRequest::Duration ? alt.Duration : alt.Length;
+
+	// trajet direct, ou depart -> via puis via -> arrivee
+	int stops[3] = { depart, via < 0 ? arrivee : via, arrivee };
+	int legs = via < 0 ? 1 : 2;
+	for(int i = 0; i < legs; ++i) {
+		auto route = sp.Query(stops[i], stops[i+1], workspace, closed);
+		result.settled += route.settled;
+		if(!route.found) {
+			result.total = 0;
+			result.path.clear();
+			return result;
+		}
+		result.total += route.distance;
+		result.path.insert(result.path.end(), route.path.begin(), route.path.end());
+	}
+	result.found = true;
+	return result;
+}
+
+std::vector<RouteResult> RouteExecutor::Run(const std::vector<RouteRequest>& requests, ThreadPool& pool) const
+{
+	int n = int(requests.size());
+	std::vector<RouteResult> results(n);
+
+	// Un espace de travail par tache: ParallelTasks n'execute jamais deux
+	// fois le meme indice en meme temps. Les blocs sont assez petits pour
+	// equilibrer la charge et assez grands pour que le compteur partage ne
+	// soit pas un goulot d'etranglement.
+	int tasks = int(std::min<long>(pool.Size(), n));
+	int block = std::max(1, std::min(64, n / (8 * std::max(1, tasks))));
+	std::vector<Workspace> workspaces(tasks);
+	std::atomic<int> next(0);
+
+	pool.ParallelTasks(tasks, [&](int t) {
+		for(;;) {
+			int begin = next.fetch_add(block, std::memory_order_relaxed);
+			if(begin >= n) break;
+			int end = std::min(n, begin + block);
+			for(int i = begin; i < end; ++i)
+				results[i] = Run(requests[i], workspaces[t]);
+		}
+	});
+	return results;
+}
+
+std::vector<RouteResult> RouteExecutor::Run(const std::vector<RouteRequest>& requests) const
+{
+	ThreadPool pool;
+	return Run(requests, pool);
+}
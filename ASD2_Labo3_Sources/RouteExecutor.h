@@ -0,0 +1,88 @@
+/*
+ * @file   RouteExecutor.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_RouteExecutor_h
+#define ASD2_RouteExecutor_h
+
+#include <string>
+#include <vector>
+
+#include "TrainNetwork.h"
+#include "TrainGraphWrapper.h"
+#include "LandmarkSP.h"
+#include "ThreadPool.h"
+
+// Execution de lots de recherches d'itineraires independantes sur le reseau
+// ferroviaire. Les graphes ponderes par la longueur et la duree des lignes
+// et les tables ALT sont construits une fois et partages, en lecture seule,
+// par tous les threads. Chaque thread a son propre espace de travail
+// (QueryWorkspace), reutilise pour toutes les requetes qu'il traite.
+//
+// Les requetes d'un lot sont reparties dynamiquement: chaque thread prend le
+// prochain bloc de requetes non traitees, de sorte qu'un thread tombant sur
+// des trajets longs ne retarde pas les autres.
+
+// Requete d'itineraire
+struct RouteRequest {
+	enum Criterion { Length, Duration };
+
+	std::string depart;
+	std::string arrivee;
+	std::string via;                  // ville de passage, vide pour un trajet direct
+	std::string closed;               // gare en travaux a eviter, vide pour aucune
+	Criterion criterion = Length;     // longueur (km) ou duree (minutes) a minimiser
+};
+
+// Resultat d'une requete
+struct RouteResult {
+	typedef CachedTrainDiGraphWrapper::Edge Edge;
+
+	bool found = false;               // vrai si un itineraire existe
+	int total = 0;                    // longueur ou duree de l'itineraire
+	std::vector<Edge> path;           // lignes empruntees, de depart a arrivee
+	int settled = 0;                  // sommets fixes par les recherches
+	std::string error;                // non vide si la requete est invalide (ville inconnue)
+};
+
+class RouteExecutor {
+public:
+	typedef ALTSP<CachedTrainDiGraphWrapper>::Workspace Workspace;
+
+private:
+	const TrainNetwork& tn;
+	TrainALT alt;
+
+	// Indice de la ville name, -1 si name est vide. Renseigne error si la
+	// ville n'existe pas.
+	int city(const std::string& name, std::string& error) const;
+
+public:
+	/**
+	 * @brief Constructeur. Construit ou relit les tables ALT du reseau.
+	 * @param tn, reseau de trains et de lignes, qui doit survivre a l'executeur
+	 * @param networkFile, nom du fichier du reseau, voir TrainALT
+	 * @param nbLandmarks, nombre de reperes ALT
+	 */
+	RouteExecutor(const TrainNetwork& tn, const std::string& networkFile, int nbLandmarks = 4);
+
+	/**
+	 * @brief Traite une requete
+	 * @param workspace, espace de travail propre au thread appelant
+	 */
+	RouteResult Run(const RouteRequest& request, Workspace& workspace) const;
+
+	/**
+	 * @brief Traite un lot de requetes en parallele sur pool. Peut etre
+	 *        appele depuis plusieurs threads a la fois.
+	 * @return les resultats, dans l'ordre des requetes
+	 */
+	std::vector<RouteResult> Run(const std::vector<RouteRequest>& requests, ThreadPool& pool) const;
+	std::vector<RouteResult> Run(const std::vector<RouteRequest>& requests) const;
+};
+
+#endif
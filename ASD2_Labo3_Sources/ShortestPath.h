@@ -16,8 +16,11 @@
 #include <algorithm>
 #include <queue>
 #include <vector>
-#include <set>
 #include <functional>
+#include <limits>
+
+#include "IndexMinPQ.h"
+#include "Instrumentation.h"
 
 
 // Classe parente de toutes les classes de plus court chemin.
@@ -26,7 +29,8 @@
 // qui permettent de les interroger.
 //
 // Le calcul des plus courts chemins est fait dans les constructeurs
-// des classes derivees.
+// des classes derivees. Elles donnent a la source l'arc edgeTo v->v de
+// poids nul, qui marque la racine de l'arbre des plus courts chemins.
 
 template<typename GraphType>   // Type du graphe pondere oriente a traiter
 							   // GraphType doit se comporter comme un
@@ -65,14 +69,29 @@ public:
 	}
 	
 
+	/**
+	 * @brief Indique si le sommet v est atteignable depuis la source
+	 * @param v, index du sommet
+	 * @return faux si la distance a v est infinie
+	 */
+	bool HasPathTo(int v) const {
+		return DistanceTo(v) != std::numeric_limits<Weight>::max();
+	}
+
 	/**
 	 * @brief Renvoie la liste ordonnee des arcs constituant un chemin le plus court du sommet source à v.
 	 * @param v, sommet dont on veut connaitre le chemin le plus court constitué d'arc
-	 * @return liste des arcs du chemin le plus court entre les 2 sommets
+	 * @return liste des arcs du chemin le plus court entre les 2 sommets,
+	 *         vide si v n'est pas atteignable ou si les arcs edgeTo forment
+	 *         un cycle (de poids negatif) avant d'atteindre la source
 	 */
 	Edges PathTo(int v) const {
 		Edges e;
-		while(DistanceTo(v) != 0) {
+		if(!HasPathTo(v)) return e;
+		// la distance ne suffit pas a reconnaitre la source: d'autres
+		// sommets peuvent etre a distance nulle
+		while(EdgeTo(v).From() != v) {
+			if(e.size() == edgeTo.size()) return Edges();
 			e.push_back(EdgeTo(v));
 			v = e.back().From();
 		}
@@ -85,93 +104,146 @@ protected:
 	Weights distanceTo;
 };
 
-// Classe a mettre en oeuvre au labo 3. S'inspirer de BellmaFordSP pour l'API
+// Algorithme de Dijkstra. Les sommets a traiter sont geres par une queue de
+// priorite indexee (tas D-aire) qui permet le decrease-key, ce qui donne une
+// complexite en O((V+E) log V). Les poids doivent etre positifs ou nuls.
 
-template<typename GraphType>
+template<typename GraphType, // Type du graphe pondere oriente a traiter
+                             // GraphType doit se comporter comme un
+                             // EdgeWeightedDiGraph et definir forEachAdjacentEdge(int,Func),
+                             // ainsi que le type GraphType::Edge
+         int D = 2,          // Arite du tas (2, 4 ou 8)
+         typename Instrumentation = NoInstrumentation> // voir Instrumentation.h
 class DijkstraSP : public ShortestPath<GraphType> {
 public:
 	typedef ShortestPath<GraphType> BASE;
 	typedef typename BASE::Edge Edge;
 	typedef typename BASE::Weight Weight;
 
+private:
+	// Queue de priorite des sommets, indexee par leur numero
+	typedef IndexMinPQ<Weight, D> MinPQ;
+
+	Instrumentation instrumentation;
+
 	/**
-	 * @brief Relachement de l'arc e
+	 * @brief Relachement de l'arc e. Met a jour la queue de priorite si
+	 *        la distance a e.To() diminue.
 	 * @param e, arc que l'on veut relaché
+	 * @param pq, queue de priorite des sommets a traiter
 	 */
-	void relax(const Edge& e) {
+	void relax(const Edge& e, MinPQ& pq) {
 		int v = e.From(), w = e.To();
 		Weight distThruE = this->distanceTo[v]+e.Weight();
-		
+
 		if(this->distanceTo[w] > distThruE) {
 			this->distanceTo[w] = distThruE;
 			this->edgeTo[w] = e;
+			instrumentation.Relax();
+			instrumentation.Enqueue(pq.PushOrDecrease(w, distThruE), pq.Size());
 		}
 	}
 
+public:
 	/**
 	 * @brief Algorithme de Dijkstra, sert à déterminer le chemin le plus court dans un graphe
 	 * @param g, graphe surlequel on veut effectuer l'algorithme
 	 * @param v, index du sommet à partir duquel on veut calculer le chemin le plus court
 	 */
-	DijkstraSP(const GraphType& g, int v)  {
-        //distTo[v] = 0 pour la ou les sources
-        //distTo[v] = infini pour les autres sommets
-        //E = ensemble de tous les sommets
-        // infini = max de unsigned
-				//
-        //unsigned distTo[g.V()];
-        //for(unsigned u : distTo){
-        //    if(u == v) distTo[u] = 0;
-        //    else{ distTo[u] = -1;}
-        //}
-        //std::priority_queue<Edge, std::vector<Edge>> pq;
-        //g.forEachAdjacentEdge (v, [&pq] (const Edge& e) -> void {pq.push(e);});
-
-        //while(!pq.empty()) {
-        //  pq.pop(std::min_element(distTo,distTo+g.V()));
-
-        //  //manque relacher tous les arcs v->w issus de v
-        //}
-
-				// Version GRH
-		    //std::vector<unsigned> distTo(g.V(), -1);
-				
-				BASE::distanceTo.resize(g.V(), std::numeric_limits<Weight>::max());
-				BASE::edgeTo.resize(g.V());
-				BASE::distanceTo.at(v) = 0;
-
-				std::set<int> toTTT;
-				g.forEachVertex([& toTTT] (int i) { toTTT.insert(i);});
-				while(!toTTT.empty()) {
-					int vertexMin = *toTTT.begin();
-					// find min
-					//
-					for(int i : toTTT)
-						if(BASE::distanceTo.at(i) < BASE::distanceTo.at(vertexMin))
-							vertexMin = i;
-
-					toTTT.erase(vertexMin);
-
-					g.forEachAdjacentEdge(vertexMin, [&toTTT, this] (const Edge& e) {
-							if(toTTT.count(e.To()) == 1)	relax(e);
-							//Weight newWeight = BASE::distanceTo.at(e.From()) + e.Weight();
-							//if(toTTT.count(e.To()) == 1 and BASE::distanceTo.at(e.To()) > newWeight) {
-							//	BASE::distanceTo.at(e.To()) = newWeight;
-							//}
-						});
+	DijkstraSP(const GraphType& g, int v) {
+		auto timer = instrumentation.Start();
+		this->edgeTo.resize(g.V());
+		this->distanceTo.assign(g.V(), std::numeric_limits<Weight>::max());
+
+		this->edgeTo[v] = Edge(v,v,0);
+		this->distanceTo[v] = 0;
+
+		std::vector<char> marked(g.V(), 0);   // sommets dont la distance est definitive
+		MinPQ pq(g.V());
+		pq.Push(v, 0);
+		instrumentation.Enqueue(false, 1);
+		instrumentation.Stop(Phase::Setup, timer);
+
+		timer = instrumentation.Start();
+		while(!pq.Empty()) {
+			int u = pq.Pop();
+			marked[u] = 1;
+			instrumentation.Settle();
+
+			g.forEachAdjacentEdge(u, [&](const Edge& e) {
+				instrumentation.Scan();
+				if(!marked[e.To()]) relax(e, pq);
+			});
+		}
+		instrumentation.Stop(Phase::Search, timer);
+	}
+
+	// Compteurs de la recherche (vides avec NoInstrumentation)
+	SearchStats Stats() const { return instrumentation.Stats(); }
+};
 
+// Algorithme de Dijkstra en version paresseuse. Utilise std::priority_queue
+// sans decrease-key: un sommet peut y figurer plusieurs fois et les entrees
+// obsoletes sont ignorees lorsqu'elles sortent de la queue. Sert de point de
+// comparaison avec DijkstraSP.
+
+template<typename GraphType>
+class DijkstraLazySP : public ShortestPath<GraphType> {
+public:
+	typedef ShortestPath<GraphType> BASE;
+	typedef typename BASE::Edge Edge;
+	typedef typename BASE::Weight Weight;
+
+private:
+	// paire distance/sommet. MinPQ::top() retourne la plus petite distance.
+	typedef std::pair<Weight,int> DistVertex;
+	typedef std::priority_queue<DistVertex,std::vector<DistVertex>,std::greater<DistVertex>> MinPQ;
+
+public:
+	/**
+	 * @brief Algorithme de Dijkstra avec suppression paresseuse
+	 * @param g, graphe surlequel on veut effectuer l'algorithme
+	 * @param v, index du sommet à partir duquel on veut calculer le chemin le plus court
+	 */
+	DijkstraLazySP(const GraphType& g, int v) {
+		this->edgeTo.resize(g.V());
+		this->distanceTo.assign(g.V(), std::numeric_limits<Weight>::max());
+
+		this->edgeTo[v] = Edge(v,v,0);
+		this->distanceTo[v] = 0;
+
+		std::vector<char> marked(g.V(), 0);
+		MinPQ pq;
+		pq.push(DistVertex(0, v));
+
+		while(!pq.empty()) {
+			int u = pq.top().second; pq.pop();
+			if(marked[u]) continue;        // entree obsolete
+			marked[u] = 1;
+
+			g.forEachAdjacentEdge(u, [&](const Edge& e) {
+				int w = e.To();
+				if(marked[w]) return;
+				Weight distThruE = this->distanceTo[u]+e.Weight();
+				if(this->distanceTo[w] > distThruE) {
+					this->distanceTo[w] = distThruE;
+					this->edgeTo[w] = e;
+					pq.push(DistVertex(distThruE, w));
 				}
+			});
+		}
 	}
 };
 
 // Algorithme de BellmanFord.
 
-template<typename GraphType> // Type du graphe pondere oriente a traiter
+template<typename GraphType, // Type du graphe pondere oriente a traiter
 							 // GraphType doit se comporter comme un
 							 // EdgeWeightedDiGraph et definir forEachEdge(Func),
 							 // ainsi que le type GraphType::Edge. Ce dernier doit
 							 // se comporter comme ASD2::DirectedEdge, c-a-dire definir From(),
 							 // To() et Weight()
+		 typename Instrumentation = NoInstrumentation> // voir Instrumentation.h
 
 class BellmanFordSP : public ShortestPath<GraphType> {
 
@@ -179,48 +251,71 @@ private:
 	typedef ShortestPath<GraphType> BASE;
 	typedef typename BASE::Edge Edge;
 	typedef typename BASE::Weight Weight;
+
+	Instrumentation instrumentation;
 	
 	
 	/**
 	 * @brief Relachement de l'arc e
 	 * @param e, arc que l'on veut relaché
+	 * @return true si la distance a e.To() a diminue
 	 */
-	void relax(const Edge& e) {
+	bool relax(const Edge& e) {
 		int v = e.From(), w = e.To();
+		if(this->distanceTo[v] == std::numeric_limits<Weight>::max())
+			return false;            // v n'est pas encore atteint
 		Weight distThruE = this->distanceTo[v]+e.Weight();
 		
 		if(this->distanceTo[w] > distThruE) {
 			this->distanceTo[w] = distThruE;
 			this->edgeTo[w] = e;
+			instrumentation.Relax();
+			return true;
 		}
+		return false;
 	}
 	
 public:
 
 	/**
-	 * @brief Constructeur a partir du graphe g et du sommet v a la source des plus courts chemins
+	 * @brief Constructeur a partir du graphe g et du sommet v a la source des plus courts chemins.
+	 *        S'arrete des qu'une passe sur tous les arcs ne modifie plus aucune distance.
 	 * @param g, graphe dans lequel on veut construire 
 	 * @param v, sommet é partir duquel on veut construire
 	 */
 	BellmanFordSP(const GraphType& g, int v) {
-		
+		auto timer = instrumentation.Start();
 		this->edgeTo.resize(g.V());
 		this->distanceTo.assign(g.V(),std::numeric_limits<Weight>::max());
 
 		this->edgeTo[v] = Edge(v,v,0);
 		this->distanceTo[v] = 0;
+		instrumentation.Stop(Phase::Setup, timer);
 		
-		for(int i=0;i<g.V();++i)
-			g.forEachEdge([this](const Edge& e){
-				this->relax(e);
+		timer = instrumentation.Start();
+		bool changed = true;
+		for(int i=0;i<g.V() && changed;++i) {
+			changed = false;
+			instrumentation.Pass();
+			g.forEachEdge([this,&changed](const Edge& e){
+				instrumentation.Scan();
+				if(this->relax(e)) changed = true;
 			});
+		}
+		instrumentation.Stop(Phase::Search, timer);
 	}
+
+	// Compteurs du calcul (vides avec NoInstrumentation)
+	SearchStats Stats() const { return instrumentation.Stats(); }
 };
 
 
-/* Fera l'objet d'un exercice de programmation
 // Algorithme de BellmanFord avec queue simple reprenant les sommets ayant
-// ete modifies par la derniere iteration.
+// ete modifies par la derniere iteration. Seuls les arcs sortant de ces
+// sommets sont relaches. Detecte les cycles de poids negatif atteignables
+// depuis la source: toutes les V relaxations de sommet, on cherche un cycle
+// dans le graphe des arcs edgeTo. Si un tel cycle existe, il est de poids
+// negatif et le calcul s'arrete.
 template<typename GraphType> // Type du graphe pondere oriente a traiter
 							 // GraphType doit se comporter comme un
 							 // EdgeWeightedDiGraph et definir forEachAdjacentEdge(int,Func),
@@ -234,12 +329,115 @@ private:
 	typedef ShortestPath<GraphType> BASE;
 	typedef typename BASE::Edge Edge;
 	typedef typename BASE::Weight Weight;
-	
+	typedef typename BASE::Edges Edges;
+
+	int source;
+	std::vector<char> onQueue;     // onQueue[v] vrai si v est dans queue
+	std::queue<int> queue;         // sommets dont les arcs sortants sont a relacher
+	int cost;                      // nombre de sommets relaches
+	Edges cycle;                   // cycle de poids negatif, vide s'il n'y en a pas
+
+	// Indique si v a un arc edgeTo valide (la source n'en a pas, sauf si
+	// un cycle negatif a diminue sa distance)
+	bool hasParent(int v) const {
+		if(this->distanceTo[v] == std::numeric_limits<Weight>::max()) return false;
+		return v != source || this->distanceTo[v] != 0;
+	}
+
+	/**
+	 * @brief Relache tous les arcs sortant de v
+	 */
+	void relax(const GraphType& g, int v) {
+		g.forEachAdjacentEdge(v, [this,v](const Edge& e) {
+			if(e.From() != v) return;
+			int w = e.To();
+			Weight distThruE = this->distanceTo[v]+e.Weight();
+
+			if(this->distanceTo[w] > distThruE) {
+				this->distanceTo[w] = distThruE;
+				this->edgeTo[w] = e;
+				if(!onQueue[w]) {
+					queue.push(w);
+					onQueue[w] = 1;
+				}
+			}
+		});
+		if(++cost % g.V() == 0)
+			findNegativeCycle();
+	}
+
+	/**
+	 * @brief Cherche un cycle dans le graphe des arcs edgeTo. Chaque sommet
+	 *        y a au plus un predecesseur; on remonte donc les predecesseurs
+	 *        de chaque sommet en marquant le chemin parcouru.
+	 */
+	void findNegativeCycle() {
+		int V = int(this->distanceTo.size());
+		std::vector<int> walk(V, -1);   // numero du parcours ayant visite le sommet
+
+		for(int s = 0; s < V && cycle.empty(); ++s) {
+			int v = s;
+			while(walk[v] == -1 && hasParent(v)) {
+				walk[v] = s;
+				v = this->edgeTo[v].From();
+			}
+			if(walk[v] != s || !hasParent(v)) continue;
+
+			// v est sur un cycle
+			int x = v;
+			do {
+				cycle.push_back(this->edgeTo[x]);
+				x = this->edgeTo[x].From();
+			} while(x != v);
+			std::reverse(cycle.begin(), cycle.end());
+		}
+	}
+
 public:
-	BellmanFordQueueSP(const GraphType& g, int v) {
-		
+	/**
+	 * @brief Constructeur a partir du graphe g et du sommet v a la source des plus courts chemins
+	 * @param g, graphe dans lequel on veut construire
+	 * @param v, sommet é partir duquel on veut construire
+	 */
+	BellmanFordQueueSP(const GraphType& g, int v) : source(v), onQueue(g.V(), 0), cost(0) {
+		this->edgeTo.resize(g.V());
+		this->distanceTo.assign(g.V(),std::numeric_limits<Weight>::max());
+
+		this->edgeTo[v] = Edge(v,v,0);
+		this->distanceTo[v] = 0;
+
+		queue.push(v);
+		onQueue[v] = 1;
+		while(!queue.empty() && !HasNegativeCycle()) {
+			int u = queue.front(); queue.pop();
+			onQueue[u] = 0;
+			relax(g, u);
+		}
+	}
+
+	/**
+	 * @brief Indique si un cycle de poids negatif est atteignable depuis la source.
+	 *        Dans ce cas les distances calculees n'ont pas de sens.
+	 */
+	bool HasNegativeCycle() const {
+		return !cycle.empty();
+	}
+
+	/**
+	 * @brief Comme ShortestPath::PathTo, mais vide si un cycle de poids
+	 *        negatif a ete trouve
+	 */
+	Edges PathTo(int v) const {
+		return HasNegativeCycle() ? Edges() : BASE::PathTo(v);
+	}
+
+	/**
+	 * @brief Renvoie les arcs d'un cycle de poids negatif, dans l'ordre, ou
+	 *        une liste vide s'il n'y en a pas.
+	 */
+	Edges NegativeCycle() const {
+		return cycle;
 	}
 };
-*/
 
 #endif
@@ -0,0 +1,65 @@
+/*
+ * @file   ThreadPool.cpp
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned nbThreads) : stop(false)
+{
+	if(nbThreads == 0)
+		nbThreads = std::thread::hardware_concurrency();
+	for(unsigned i = 1; i < nbThreads; ++i)
+		workers.emplace_back([this] { work(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	cv.notify_all();
+	for(std::thread& t : workers)
+		t.join();
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push_back(std::move(task));
+	}
+	cv.notify_one();
+}
+
+bool ThreadPool::runPending()
+{
+	std::function<void()> task;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(tasks.empty()) return false;
+		task = std::move(tasks.front());
+		tasks.pop_front();
+	}
+	task();
+	return true;
+}
+
+void ThreadPool::work()
+{
+	for(;;) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cv.wait(lock, [this] { return stop || !tasks.empty(); });
+			if(tasks.empty()) return;
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+	}
+}
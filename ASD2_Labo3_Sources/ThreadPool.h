@@ -0,0 +1,159 @@
+/*
+ * @file   ThreadPool.h
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ */
+
+#ifndef ASD2_ThreadPool_h
+#define ASD2_ThreadPool_h
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+// Groupe de threads executant des taches. Utilise par les algorithmes
+// paralleles (Bellman-Ford parallele, delta-stepping, Boruvka, ...).
+//
+// Un pool de taille N utilise N-1 threads de travail: le thread appelant
+// ParallelFor execute lui-meme une partie du travail, et execute les taches
+// en attente plutot que de bloquer. ParallelFor peut donc etre appele depuis
+// une tache du pool sans risque d'interblocage. Un pool de taille 1 execute
+// tout dans le thread appelant.
+
+class ThreadPool {
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable cv;
+	bool stop;
+
+	// boucle des threads de travail
+	void work();
+
+	// execute une tache en attente s'il y en a une
+	bool runPending();
+
+public:
+	/**
+	 * @brief Constructeur
+	 * @param nbThreads nombre de threads participant aux calculs, appelant
+	 *        compris. 0 pour std::thread::hardware_concurrency().
+	 */
+	explicit ThreadPool(unsigned nbThreads = 0);
+
+	// Attend la fin des taches en cours et arrete les threads
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Nombre de threads participant aux calculs, appelant compris
+	unsigned Size() const { return unsigned(workers.size()) + 1; }
+
+	/**
+	 * @brief Ajoute une tache a executer par un thread du pool
+	 */
+	void Submit(std::function<void()> task);
+
+	/**
+	 * @brief Execute f(i) pour i dans [0,n) en parallele et attend la fin.
+	 *        Si une tache leve une exception, la premiere est relancee.
+	 */
+	template<typename Func>
+	void ParallelTasks(int n, Func f) {
+		if(n <= 0) return;
+		if(n == 1 || workers.empty()) {
+			for(int i = 0; i < n; ++i) f(i);
+			return;
+		}
+
+		std::mutex m;
+		std::condition_variable done;
+		int remaining = n - 1;
+		std::exception_ptr error;
+
+		for(int i = 1; i < n; ++i)
+			Submit([&, i] {
+				try { f(i); }
+				catch(...) { std::lock_guard<std::mutex> lock(m); if(!error) error = std::current_exception(); }
+				std::lock_guard<std::mutex> lock(m);
+				if(--remaining == 0) done.notify_all();
+			});
+
+		try { f(0); }
+		catch(...) { std::lock_guard<std::mutex> lock(m); if(!error) error = std::current_exception(); }
+
+		for(;;) {
+			{
+				std::unique_lock<std::mutex> lock(m);
+				if(remaining == 0) break;
+			}
+			if(!runPending()) {
+				std::unique_lock<std::mutex> lock(m);
+				done.wait(lock, [&] { return remaining == 0; });
+				break;
+			}
+		}
+		if(error) std::rethrow_exception(error);
+	}
+
+	/**
+	 * @brief Decoupe [begin,end) en au plus Size() intervalles contigus et
+	 *        execute f(lo,hi) sur chacun en parallele.
+	 */
+	template<typename Func>
+	void ParallelFor(int begin, int end, Func f) {
+		int n = end - begin;
+		if(n <= 0) return;
+		int chunks = int(Size()) < n ? int(Size()) : n;
+		ParallelTasks(chunks, [&](int c) {
+			f(begin + int(long(n) * c / chunks), begin + int(long(n) * (c+1) / chunks));
+		});
+	}
+
+	/**
+	 * @brief Trie [begin,end) en parallele: chaque thread trie un bloc avec
+	 *        std::sort, puis les blocs sont fusionnes deux a deux, les
+	 *        fusions d'un meme niveau etant paralleles. Les petits
+	 *        intervalles sont tries directement.
+	 */
+	template<typename RandomIt, typename Compare>
+	void ParallelSort(RandomIt begin, RandomIt end, Compare comp) {
+		const long minChunk = 4096;
+		long n = long(std::distance(begin, end));
+		int chunks = int(std::min<long>(Size(), n / minChunk));
+		if(chunks <= 1) {
+			std::sort(begin, end, comp);
+			return;
+		}
+
+		std::vector<RandomIt> bounds;
+		for(int c = 0; c <= chunks; ++c)
+			bounds.push_back(begin + n * c / chunks);
+
+		ParallelTasks(chunks, [&](int c) {
+			std::sort(bounds[c], bounds[c+1], comp);
+		});
+		for(int width = 1; width < chunks; width *= 2) {
+			int merges = (chunks + 2*width - 1) / (2*width);
+			ParallelTasks(merges, [&](int m) {
+				int lo = 2 * width * m;
+				int mid = std::min(lo + width, chunks);
+				int hi = std::min(lo + 2*width, chunks);
+				if(mid < hi)
+					std::inplace_merge(bounds[lo], bounds[mid], bounds[hi], comp);
+			});
+		}
+	}
+};
+
+#endif
@@ -1,4 +1,4 @@
-/* 
+/*
  * @file   TrainGraphWrapper.h
  * @author Gabriel Roch
  * @author Gwendoline Dossegger
@@ -6,9 +6,25 @@
  *
  */
 
+#ifndef ASD2_TrainGraphWrapper_h
+#define ASD2_TrainGraphWrapper_h
+
 #include "TrainNetwork.h"
 #include "EdgeWeightedGraph.h"
+#include "CSRGraph.h"
 #include <functional>
+#include <limits>
+#include <vector>
+
+// Les wrappers presentent le reseau de trains comme un graphe dont le poids
+// des lignes est donne par une fonction fnWeight. Le type de fnWeight est un
+// parametre du template: avec un lambda (MakeTrainGraphWrapper,
+// MakeTrainDiGraphWrapper) l'appel peut etre inline, TrainGraphWrapper et
+// TrainDiGraphWrapper utilisent std::function.
+//
+// fnWeight est rappelee a chaque parcours. CachedTrainGraphWrapper et
+// CachedTrainDiGraphWrapper l'evaluent une seule fois par ligne et rangent
+// les poids au format CSR, sans les lignes fermees.
 
 class TrainGraphWrapperCommon {
 	public:
@@ -16,18 +32,13 @@ class TrainGraphWrapperCommon {
 		typedef std::function<Weight(TrainNetwork::Line const &)> FnWeightType;
 	protected:
 		TrainNetwork const & tn;
-		FnWeightType fnWeight;
 	protected:
 		/**
 		 * @brief Constructeur de la classe TrainGraphWrapperCommon
 		 * @param tn réseau de train
-		 * @param fnWeight Fonction convertisant un TrainNetwork::Line en 
-		 *	               poids (int)
-		 * @attention si fnWeight renvoie numeric_limits<Weight>::max(), alors la liaison
-		 *						est considérée comme inexistante.
 		 */
-		TrainGraphWrapperCommon(TrainNetwork const & tn, FnWeightType fnWeight)
-			: tn(tn), fnWeight(fnWeight) 
+		TrainGraphWrapperCommon(TrainNetwork const & tn)
+			: tn(tn)
 		{
 		}
 	public:
@@ -47,17 +58,40 @@ class TrainGraphWrapperCommon {
 				f(v);
 			}
 		}
+};
+
+template<typename FnWeight = TrainGraphWrapperCommon::FnWeightType>
+class BasicTrainGraphWrapper : public TrainGraphWrapperCommon {
+	public:
+    typedef WeightedEdge<Weight> Edge;
+	private:
+		FnWeight fnWeight;
+	public:
+		/**
+		 * @brief Constructeur de la classe TrainGraphWrapper
+		 * @param tn réseau de train
+		 * @param fnWeight Fonction convertisant un TrainNetwork::Line en
+		 *	               poids (int)
+		 * @attention si fnWeight renvoie numeric_limits<Weight>::max(), alors la liaison
+		 *						est considérée comme inexistante.
+		 */
+		BasicTrainGraphWrapper(TrainNetwork const & tn, FnWeight fnWeight)
+			: TrainGraphWrapperCommon(tn), fnWeight(fnWeight)
+		{
+		}
+
 
 		/**
-		 * @brief Parcours de tous les sommets adjacents au sommet v
-		 *        la fonction f doit prendre un seul argument de type int
+		 * @brief Parcours de tous les sommets adjacents au sommet v par une
+		 *        ligne ouverte. la fonction f doit prendre un seul argument de type int
 		 * @param v sommet sur lequel il faut itérer les sommets adjacents
 		 * @param f fonction que l'on veut effectuer
 		 */
  		template<typename Func >
- 		void forEachAdjacentVertex (int v, Func f) const { // À vérifier
+ 		void forEachAdjacentVertex (int v, Func f) const {
  			for(int lineid : tn.cities[v].lines) {
- 				TrainNetwork::Line e = tn.lines[lineid];
+ 				TrainNetwork::Line const & e = tn.lines[lineid];
+ 				if(fnWeight(e) == std::numeric_limits<Weight>::max()) continue;
  				if(e.cities.first == v) {
  					f(e.cities.second);
  				} else {
@@ -65,27 +99,10 @@ class TrainGraphWrapperCommon {
  				}
  			}
  		}
-};
-
-class TrainGraphWrapper : public TrainGraphWrapperCommon {
-	public:
-    typedef WeightedEdge<Weight> Edge;
-	public:
-		/**
-		 * @brief Constructeur de la classe TrainGraphWrapper
-		 * @param tn réseau de train
-		 * @param fnWeight Fonction convertisant un TrainNetwork::Line en 
-		 *	               poids (int)
-		 */
-		TrainGraphWrapper(TrainNetwork const & tn, FnWeightType fnWeight)
-			: TrainGraphWrapperCommon(tn, fnWeight)
-		{
-		}
-
 
 		/**
 		 * @brief Parcours des arcs/arêtes adjacentes au sommet v.
-		 *        la fonction f doit prendre un seul argument de type 
+		 *        la fonction f doit prendre un seul argument de type
 		 *        ...::Edge
 		 * @param v sommet sur lequel il faut itérer au arc adjacents
 		 * @param f Fonction à appliquer
@@ -93,54 +110,74 @@ class TrainGraphWrapper : public TrainGraphWrapperCommon {
  		template<typename Func>
  		void forEachAdjacentEdge(int v, Func f) const  {
  			for(int lineid : tn.cities[v].lines) {
-				if(fnWeight(tn.lines[lineid]) != std::numeric_limits<Weight>::max()) {
-					f(Edge(
-							tn.lines[lineid].cities.first, 
-							tn.lines[lineid].cities.second,
-							fnWeight(tn.lines[lineid])
-							));
+				TrainNetwork::Line const & line = tn.lines[lineid];
+				Weight w = fnWeight(line);
+				if(w != std::numeric_limits<Weight>::max()) {
+					f(Edge(line.cities.first, line.cities.second, w));
 				}
  			}
  		}
 
 		/**
 		 * @brief Parcours de toutes les arêtes du graphe.
-		 *        la fonction f doit prendre un seul argument de type 
+		 *        la fonction f doit prendre un seul argument de type
 		 *        ...::Edge
 		 * @param f Fonction à appliquer
 		 */
  		template<typename Func>
  		void forEachEdge(Func f) const {
  			for(TrainNetwork::Line const & line : tn.lines) {
-				if(fnWeight(line) != std::numeric_limits<Weight>::max()) {
-					f(Edge(
-							line.cities.first, 
-							line.cities.second,
-							fnWeight(line)
-							));
+				Weight w = fnWeight(line);
+				if(w != std::numeric_limits<Weight>::max()) {
+					f(Edge(line.cities.first, line.cities.second, w));
 				}
 			}
 		}
 };
 
-class TrainDiGraphWrapper : public TrainGraphWrapperCommon{
+template<typename FnWeight = TrainGraphWrapperCommon::FnWeightType>
+class BasicTrainDiGraphWrapper : public TrainGraphWrapperCommon {
 	public:
     typedef WeightedDirectedEdge<Weight> Edge;
+	private:
+		FnWeight fnWeight;
 	public:
 		/**
 		 * @brief Constructeur de la classe TrainDiGraphWrapper
 		 * @param tn réseau de train
-		 * @param fnWeight Fonction convertisant un TrainNetwork::Line en 
+		 * @param fnWeight Fonction convertisant un TrainNetwork::Line en
 		 *	               poids (int)
+		 * @attention si fnWeight renvoie numeric_limits<Weight>::max(), alors la liaison
+		 *						est considérée comme inexistante.
 		 */
-		TrainDiGraphWrapper(TrainNetwork const & tn, FnWeightType fnWeight)
-			: TrainGraphWrapperCommon(tn, fnWeight)
+		BasicTrainDiGraphWrapper(TrainNetwork const & tn, FnWeight fnWeight)
+			: TrainGraphWrapperCommon(tn), fnWeight(fnWeight)
 		{
 		}
 
 		/**
-		 * @brief Parcours des arcs/arêtes adjacentes au sommet v.
-		 *        la fonction f doit prendre un seul argument de type 
+		 * @brief Parcours de tous les sommets adjacents au sommet v par une
+		 *        ligne ouverte. la fonction f doit prendre un seul argument de type int
+		 * @param v sommet sur lequel il faut itérer les sommets adjacents
+		 * @param f fonction que l'on veut effectuer
+		 */
+ 		template<typename Func >
+ 		void forEachAdjacentVertex (int v, Func f) const {
+ 			for(int lineid : tn.cities[v].lines) {
+ 				TrainNetwork::Line const & e = tn.lines[lineid];
+ 				if(fnWeight(e) == std::numeric_limits<Weight>::max()) continue;
+ 				if(e.cities.first == v) {
+ 					f(e.cities.second);
+ 				} else {
+ 					f(e.cities.first);
+ 				}
+ 			}
+ 		}
+
+		/**
+		 * @brief Parcours des arcs partant du sommet v. Chaque ligne
+		 *        donne un arc dans chaque sens.
+		 *        la fonction f doit prendre un seul argument de type
 		 *        ...::Edge
 		 * @param v sommet sur lequel il faut itérer au arc adjacents
 		 * @param f Fonction à appliquer
@@ -148,43 +185,118 @@ class TrainDiGraphWrapper : public TrainGraphWrapperCommon{
  		template<typename Func>
  		void forEachAdjacentEdge(int v, Func f) const  {
  			for(int lineid : tn.cities[v].lines) {
-				if(fnWeight(tn.lines[lineid]) != std::numeric_limits<Weight>::max()) {
-					f(Edge(
-							tn.lines[lineid].cities.first, 
-							tn.lines[lineid].cities.second,
-							fnWeight(tn.lines[lineid])
-							));
-					f(Edge(
-							tn.lines[lineid].cities.second,
-							tn.lines[lineid].cities.first, 
-							fnWeight(tn.lines[lineid])
-							));
+				TrainNetwork::Line const & line = tn.lines[lineid];
+				Weight w = fnWeight(line);
+				if(w != std::numeric_limits<Weight>::max()) {
+					int other = line.cities.first == v ? line.cities.second : line.cities.first;
+					f(Edge(v, other, w));
 				}
  			}
  		}
 
 		/**
-		 * @brief Parcours de toutes les arêtes du graphe.
-		 *        la fonction f doit prendre un seul argument de type 
+		 * @brief Parcours de tous les arcs du graphe.
+		 *        la fonction f doit prendre un seul argument de type
 		 *        ...::Edge
 		 * @param f Fonction à appliquer
 		 */
  		template<typename Func>
  		void forEachEdge(Func f) const {
  			for(TrainNetwork::Line const & line : tn.lines) {
-				if(fnWeight(line) != std::numeric_limits<Weight>::max()) {
-					f(Edge(
-							line.cities.second,
-							line.cities.first, 
-							fnWeight(line)
-							));
-					f(Edge(
-							line.cities.first, 
-							line.cities.second,
-							fnWeight(line)
-							));
+				Weight w = fnWeight(line);
+				if(w != std::numeric_limits<Weight>::max()) {
+					f(Edge(line.cities.second, line.cities.first, w));
+					f(Edge(line.cities.first, line.cities.second, w));
 				}
 			}
 		}
 };
 
+typedef BasicTrainGraphWrapper<> TrainGraphWrapper;
+typedef BasicTrainDiGraphWrapper<> TrainDiGraphWrapper;
+
+/**
+ * @brief Wrapper non oriente dont le type de fnWeight est celui du lambda
+ */
+template<typename FnWeight>
+BasicTrainGraphWrapper<FnWeight> MakeTrainGraphWrapper(TrainNetwork const & tn, FnWeight fnWeight) {
+	return BasicTrainGraphWrapper<FnWeight>(tn, fnWeight);
+}
+
+/**
+ * @brief Wrapper oriente dont le type de fnWeight est celui du lambda
+ */
+template<typename FnWeight>
+BasicTrainDiGraphWrapper<FnWeight> MakeTrainDiGraphWrapper(TrainNetwork const & tn, FnWeight fnWeight) {
+	return BasicTrainDiGraphWrapper<FnWeight>(tn, fnWeight);
+}
+
+namespace TrainGraphDetail {
+	/**
+	 * @brief Tableaux CSR des lignes ouvertes du reseau, fnWeight etant
+	 *        appelee une seule fois par ligne
+	 * @param undirected si vrai chaque ligne figure dans les listes de ses
+	 *        deux villes, sinon elle donne un arc dans chaque sens
+	 */
+	template<typename Graph, typename FnWeight>
+	std::shared_ptr<typename Graph::Storage> build(TrainNetwork const & tn, FnWeight& fnWeight, bool undirected) {
+		typedef TrainGraphWrapperCommon::Weight Weight;
+		std::vector<int> from, to;
+		std::vector<Weight> weight;
+		size_t n = undirected ? tn.lines.size() : 2 * tn.lines.size();
+		from.reserve(n); to.reserve(n); weight.reserve(n);
+		for(TrainNetwork::Line const & line : tn.lines) {
+			Weight w = fnWeight(line);
+			if(w == std::numeric_limits<Weight>::max()) continue;
+			from.push_back(line.cities.first);
+			to.push_back(line.cities.second);
+			weight.push_back(w);
+			if(!undirected) {
+				from.push_back(line.cities.second);
+				to.push_back(line.cities.first);
+				weight.push_back(w);
+			}
+		}
+		return Graph::BuildStorage(int(tn.cities.size()), from, to, weight, undirected);
+	}
+}
+
+// Reseau de trains fige au format CSR, non oriente. Chaque ligne ouverte
+// figure dans les listes de ses deux villes.
+
+class CachedTrainGraphWrapper : public CSRGraph<TrainGraphWrapperCommon::Weight> {
+	public:
+		/**
+		 * @brief Constructeur. Evalue fnWeight une fois par ligne.
+		 * @param tn réseau de train
+		 * @param fnWeight Fonction convertisant un TrainNetwork::Line en
+		 *	               poids (int). Les lignes de poids
+		 *	               numeric_limits<Weight>::max() sont ignorees.
+		 */
+		template<typename FnWeight>
+		CachedTrainGraphWrapper(TrainNetwork const & tn, FnWeight fnWeight)
+			: CSRGraph<WeightType>(TrainGraphDetail::build<CSRGraph<WeightType>>(tn, fnWeight, true))
+		{
+		}
+};
+
+// Reseau de trains fige au format CSR, oriente. Chaque ligne ouverte donne
+// un arc dans chaque sens, range dans la liste de sa ville de depart.
+
+class CachedTrainDiGraphWrapper : public CSRDiGraph<TrainGraphWrapperCommon::Weight> {
+	public:
+		/**
+		 * @brief Constructeur. Evalue fnWeight une fois par ligne.
+		 * @param tn réseau de train
+		 * @param fnWeight Fonction convertisant un TrainNetwork::Line en
+		 *	               poids (int). Les lignes de poids
+		 *	               numeric_limits<Weight>::max() sont ignorees.
+		 */
+		template<typename FnWeight>
+		CachedTrainDiGraphWrapper(TrainNetwork const & tn, FnWeight fnWeight)
+			: CSRDiGraph<WeightType>(TrainGraphDetail::build<CSRDiGraph<WeightType>>(tn, fnWeight, false))
+		{
+		}
+};
+
+#endif
@@ -8,6 +8,7 @@
 #include "UnionFind.h"
 
 #include <vector>
+#include <utility>
 
 // Constructeur: spécifie le nombre N d'éléments
 UnionFind::UnionFind(int N)
@@ -20,9 +21,15 @@ UnionFind::UnionFind(int N)
 
 // Find renvoie l'id représentatif de la classe d'équivalence de p.
 int UnionFind::Find(int p) {
-	if( id[p] != p )
-		id[p] = Find(id[p]);      // compression de chemin par récursion
-	return id[p];
+	int root = p;
+	while( id[root] != root )
+		root = id[root];
+	while( id[p] != root ) {      // compression de chemin, sans récursion
+		int next = id[p];
+		id[p] = root;
+		p = next;
+	}
+	return root;
 }
 
 // Connected indique que p et q appartiennent à la même classe d'équivalence
@@ -46,3 +53,133 @@ void UnionFind::Union(int p, int q)
 	}
 }
 
+// Constructeur: spécifie le nombre N d'éléments
+CompactUnionFind::CompactUnionFind(int N) : parent(N, -1), count(N)
+{
+}
+
+// Find renvoie l'id représentatif de la classe d'équivalence de p.
+int CompactUnionFind::Find(int p)
+{
+	while( parent[p] >= 0 ) {
+		int q = parent[p];
+		if( parent[q] >= 0 ) {        // path halving: p saute a son grand-parent
+			parent[p] = parent[q];
+			q = parent[q];
+		}
+		p = q;
+	}
+	return p;
+}
+
+// Find qui compte les liens parcourus
+int CompactUnionFind::Find(int p, int& steps)
+{
+	steps = 0;
+	while( parent[p] >= 0 ) {
+		int q = parent[p];
+		if( parent[q] >= 0 ) {
+			parent[p] = parent[q];
+			q = parent[q];
+			++steps;
+		}
+		++steps;
+		p = q;
+	}
+	return p;
+}
+
+// Connected indique que p et q appartiennent à la même classe d'équivalence
+bool CompactUnionFind::Connected(int p, int q)
+{
+	return Find(p) == Find(q);
+}
+
+// Unite fusionne les classes d'équivalence de p et q
+bool CompactUnionFind::Unite(int p, int q)
+{
+	int i = Find(p);
+	int j = Find(q);
+	if( i == j ) return false;
+	if( parent[i] > parent[j] )    // on attache l'arbre le plus petit à la racine du plus grand
+		std::swap(i, j);
+	parent[i] += parent[j];
+	parent[j] = i;
+	--count;
+	return true;
+}
+
+// Unite qui compte les liens parcourus
+bool CompactUnionFind::Unite(int p, int q, int& stepsP, int& stepsQ)
+{
+	int i = Find(p, stepsP);
+	int j = Find(q, stepsQ);
+	if( i == j ) return false;
+	if( parent[i] > parent[j] )
+		std::swap(i, j);
+	parent[i] += parent[j];
+	parent[j] = i;
+	--count;
+	return true;
+}
+
+// UnionAll fusionne les classes des paires dans l'ordre
+std::vector<int> CompactUnionFind::UnionAll(const std::vector<std::pair<int,int>>& pairs)
+{
+	std::vector<int> merged;
+	for(int k=0;k<int(pairs.size());++k)
+		if( Unite(pairs[k].first, pairs[k].second) )
+			merged.push_back(k);
+	return merged;
+}
+// Constructeur: spécifie le nombre N d'éléments
+ConcurrentUnionFind::ConcurrentUnionFind(int N) : parent(N)
+{
+	for(int i=0;i<N;++i)
+		parent[i].store(i, std::memory_order_relaxed);
+}
+
+// Priorite des racines: melange de Fibonacci de l'indice, puis l'indice
+bool ConcurrentUnionFind::linkUnder(int p, int q)
+{
+	unsigned hp = unsigned(p) * 2654435769u, hq = unsigned(q) * 2654435769u;
+	return hp < hq || (hp == hq && p < q);
+}
+
+// Find renvoie l'id représentatif de la classe d'équivalence de p.
+int ConcurrentUnionFind::Find(int p)
+{
+	for(;;) {
+		int q = parent[p].load(std::memory_order_acquire);
+		int r = parent[q].load(std::memory_order_acquire);
+		if( q == r ) return q;
+		parent[p].compare_exchange_weak(q, r, std::memory_order_release, std::memory_order_relaxed);
+		p = q;
+	}
+}
+
+// Connected indique que p et q appartiennent à la même classe d'équivalence
+bool ConcurrentUnionFind::Connected(int p, int q)
+{
+	for(;;) {
+		p = Find(p);
+		q = Find(q);
+		if( p == q ) return true;
+		// p est encore une racine: les classes etaient bien distinctes
+		if( parent[p].load(std::memory_order_acquire) == p ) return false;
+	}
+}
+
+// Unite fusionne les classes d'équivalence de p et q
+bool ConcurrentUnionFind::Unite(int p, int q)
+{
+	for(;;) {
+		p = Find(p);
+		q = Find(q);
+		if( p == q ) return false;
+		if( !linkUnder(p, q) ) std::swap(p, q);
+		int expected = p;
+		if( parent[p].compare_exchange_strong(expected, q, std::memory_order_acq_rel) )
+			return true;
+	}
+}
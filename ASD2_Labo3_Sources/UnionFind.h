@@ -9,6 +9,8 @@
 #define ASD2_UnionFind_h
 
 #include <vector>
+#include <atomic>
+#include <utility>
 
 //  Cette classe met en oeuvre de la structure Union-Find, aussi connue
 //  sous le nom de disjoint sets. Utilisé par l'algorithme de
@@ -38,4 +40,99 @@ public:
 	void Union(int p, int q);
 };
 
+//  Union-Find sequentiel compact. Un seul tableau: parent[i] >= 0 est le
+//  parent de i, parent[i] < 0 indique une racine dont la classe compte
+//  -parent[i] elements. Find est iteratif et fait pointer un element sur
+//  deux vers son grand-parent (path halving) en une seule passe. Unite
+//  renvoie si la fusion a eu lieu, ce qui evite l'appel a Connected suivi
+//  de Union qui cherche deux fois chaque racine.
+
+class CompactUnionFind
+{
+private:
+	std::vector<int> parent;
+
+	// nombre de classes d'équivalence
+	int count;
+
+public:
+
+	// Constructeur: spécifie le nombre N d'éléments
+	CompactUnionFind(int N);
+
+	// Find renvoie l'id représentatif de la classe d'équivalence de p.
+	int Find(int p);
+
+	// Find qui renvoie aussi dans steps le nombre de liens parcourus, pour
+	// mesurer la profondeur des arbres
+	int Find(int p, int& steps);
+
+	// Connected indique que p et q appartiennent à la même classe d'équivalence
+	bool Connected(int p, int q);
+
+	// Unite fusionne les classes d'équivalence de p et q. Renvoie vrai si
+	// elles ont ete fusionnees, faux si elles etaient deja confondues.
+	bool Unite(int p, int q);
+
+	// Unite qui renvoie aussi dans stepsP et stepsQ le nombre de liens
+	// parcourus par les recherches des racines de p et de q
+	bool Unite(int p, int q, int& stepsP, int& stepsQ);
+
+	// Union fusionne les classes d'équivalence de p et q
+	void Union(int p, int q) { Unite(p, q); }
+
+	// UnionAll fusionne les classes des paires dans l'ordre et renvoie les
+	// indices des paires qui ont fusionne deux classes. Avec des aretes
+	// triees par poids, c'est la boucle de Kruskal.
+	std::vector<int> UnionAll(const std::vector<std::pair<int,int>>& pairs);
+
+	// Nombre d'éléments de la classe d'équivalence de p
+	int SizeOf(int p) { return -parent[Find(p)]; }
+
+	// Nombre de classes d'équivalence
+	int Count() const { return count; }
+};
+
+//  Union-Find utilisable par plusieurs threads a la fois, par exemple pour
+//  l'algorithme de Boruvka parallele ou le calcul de composantes connexes.
+//
+//  Le parent de chaque element est un entier atomique. Find suit les parents
+//  en faisant pointer chaque element visite vers son grand-parent (path
+//  splitting) par compare-and-swap: un echec signifie qu'un autre thread a
+//  deja raccourci le chemin et n'est pas un probleme. Unite relie une racine a
+//  l'autre par compare-and-swap, et recommence si la racine a ete reliee
+//  entre-temps par un autre thread. Les racines sont reliees selon une
+//  priorite fixe (un melange de leur indice), ce qui evite les cycles et
+//  donne des arbres peu profonds quel que soit l'ordre des unions.
+
+class ConcurrentUnionFind
+{
+private:
+	// parent[i] est le parent de i, parent[i] == i pour une racine
+	std::vector<std::atomic<int>> parent;
+
+	// vrai si la racine p doit etre reliee sous la racine q
+	static bool linkUnder(int p, int q);
+
+public:
+
+	// Constructeur: spécifie le nombre N d'éléments
+	ConcurrentUnionFind(int N);
+
+	// Nombre d'elements
+	int Size() const { return int(parent.size()); }
+
+	// Find renvoie l'id représentatif de la classe d'équivalence de p.
+	// Le representant peut changer si d'autres threads font des unions.
+	int Find(int p);
+
+	// Connected indique que p et q appartiennent à la même classe
+	// d'équivalence au moment de l'appel
+	bool Connected(int p, int q);
+
+	// Unite fusionne les classes d'équivalence de p et q. Renvoie vrai si
+	// cet appel les a fusionnees, faux si elles etaient deja confondues.
+	bool Unite(int p, int q);
+};
+
 #endif
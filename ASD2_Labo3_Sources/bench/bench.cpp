@@ -0,0 +1,317 @@
+/*
+ * @file   bench.cpp
+ * @author Gabriel Roch
+ * @author Gwendoline Dossegger
+ * @author Jean-Luc Blanc
+ *
+ * Mesure les algorithmes de plus courts chemins et d'arbre couvrant minimum
+ * sur les graphes fournis et sur des graphes synthetiques, et ecrit les
+ * resultats au format JSON pour comparer deux versions.
+ *
+ * Utilisation: bench/bench [options]
+ *   --data DIR          repertoire des fichiers EWD (defaut: .)
+ *   --output FILE       fichier JSON a ecrire (defaut: sortie standard)
+ *   --warmup N          executions non mesurees par source (defaut: 2)
+ *   --repetitions N     executions mesurees par source (defaut: 5)
+ *   --sources N         nombre de sources par graphe (defaut: 4)
+ *   --seed N            graine des sources et des graphes synthetiques
+ *   --edges N           nombre d'aretes des graphes synthetiques (defaut: 250000)
+ *   --bf-limit N        nombre maximal d'arcs pour BellmanFordSP, qui est
+ *                       en O(VE) (defaut: 200000)
+ *   --ch-limit N        nombre maximal d'arcs pour le pretraitement de
+ *                       ContractionHierarchy, mesure une seule fois par
+ *                       graphe (defaut: 200000)
+ *   --filter TEXT       ne mesure que les algorithmes ou graphes dont le nom
+ *                       contient TEXT
+ *
+ * Apres les mesures, les algorithmes instrumentes (voir Instrumentation.h)
+ * sont executes une fois de plus avec CountingInstrumentation, depuis la
+ * premiere source, et leurs compteurs sont ajoutes au resultat.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <functional>
+#include <stdexcept>
+#include <cmath>
+
+#include "Benchmark.h"
+#include "Instrumentation.h"
+#include "CSRGraph.h"
+#include "EWDReader.h"
+#include "ShortestPath.h"
+#include "ContractionHierarchy.h"
+#include "MinimumSpanningTree.h"
+#include "GraphGenerator.h"
+#include "TrainNetwork.h"
+
+using namespace std;
+
+typedef CSRDiGraph<double> DiGraph;
+typedef CSRGraph<double> Graph;
+
+struct Options {
+	string data = ".";
+	string output;
+	int warmup = 2;
+	int repetitions = 5;
+	int sources = 4;
+	unsigned seed = 42;
+	int edges = 250000;
+	int bfLimit = 200000;
+	int chLimit = 200000;
+	string filter;
+};
+
+// Un graphe de test, sous ses formes orientee et non orientee
+struct Dataset {
+	string name;
+	DiGraph directed;
+	Graph undirected;
+};
+
+// Resultat de la mesure d'un algorithme sur un graphe
+struct Result {
+	string algorithm;
+	string graph;
+	int V;
+	int E;
+	Statistics stats;
+	double edgesPerSecond;
+	bool counted;           // counters est rempli
+	SearchStats counters;
+};
+
+// empeche le compilateur de supprimer les calculs mesures
+volatile double sink;
+
+// Graphe synthetique produit par GraphGenerator. Les graphes non orientes
+// donnent un arc dans chaque sens a la version orientee.
+Dataset makeDataset(const string& name, const GraphGenerator::Edges& a, bool directed) {
+	return Dataset{ name,
+	                GraphGenerator::MakeCSRDiGraph(directed ? a : GraphGenerator::Symmetrize(a)),
+	                GraphGenerator::MakeCSRGraph(a) };
+}
+
+// Mesure run(source) pour plusieurs sources et regroupe tous les temps.
+// count(source), s'il est donne, execute la version instrumentee de
+// l'algorithme et renvoie ses compteurs.
+Result measure(const string& algorithm, const Dataset& d, int E, const vector<int>& sources,
+               const Options& opt, function<void(int)> run,
+               function<SearchStats(int)> count = nullptr) {
+	vector<double> samples;
+	for(int s : sources) {
+		vector<double> t = Measure([&] { run(s); }, opt.warmup, opt.repetitions);
+		samples.insert(samples.end(), t.begin(), t.end());
+	}
+	Result r{ algorithm, d.name, d.directed.V(), E, Summarize(samples), 0, false, SearchStats() };
+	if(count) {
+		r.counted = true;
+		r.counters = count(sources.front());
+	}
+	r.edgesPerSecond = r.stats.median > 0 ? E / r.stats.median : 0;
+	cerr << "  " << algorithm << " on " << d.name << ": median " << r.stats.median * 1000 << " ms" << endl;
+	return r;
+}
+
+void benchDataset(const Dataset& d, const Options& opt, vector<Result>& results) {
+	bool all = opt.filter.empty() || d.name.find(opt.filter) != string::npos;
+	auto selected = [&](const string& algorithm) {
+		return all || algorithm.find(opt.filter) != string::npos;
+	};
+
+	mt19937 rng(opt.seed);
+	uniform_int_distribution<int> vertex(0, d.directed.V() - 1);
+	vector<int> sources;
+	for(int i = 0; i < opt.sources; ++i) sources.push_back(vertex(rng));
+	// les algorithmes d'arbre couvrant n'ont pas de source: autant de
+	// mesures, toutes sur le graphe entier
+	vector<int> noSource(opt.sources, 0);
+
+	int arcs = d.directed.Entries();
+	int edges = d.undirected.Entries() / 2;
+
+	if(selected("DijkstraSP"))
+		results.push_back(measure("DijkstraSP", d, arcs, sources, opt, [&](int s) {
+			DijkstraSP<DiGraph> sp(d.directed, s);
+			sink = sp.DistanceTo(sources.front());
+		}, [&](int s) {
+			return DijkstraSP<DiGraph,2,CountingInstrumentation>(d.directed, s).Stats();
+		}));
+	if(selected("DijkstraSP<4>"))
+		results.push_back(measure("DijkstraSP<4>", d, arcs, sources, opt, [&](int s) {
+			DijkstraSP<DiGraph,4> sp(d.directed, s);
+			sink = sp.DistanceTo(sources.front());
+		}, [&](int s) {
+			return DijkstraSP<DiGraph,4,CountingInstrumentation>(d.directed, s).Stats();
+		}));
+	if(selected("BellmanFordSP") && arcs <= opt.bfLimit)
+		results.push_back(measure("BellmanFordSP", d, arcs, sources, opt, [&](int s) {
+			BellmanFordSP<DiGraph> sp(d.directed, s);
+			sink = sp.DistanceTo(sources.front());
+		}, [&](int s) {
+			return BellmanFordSP<DiGraph,CountingInstrumentation>(d.directed, s).Stats();
+		}));
+	if(selected("BellmanFordQueueSP"))
+		results.push_back(measure("BellmanFordQueueSP", d, arcs, sources, opt, [&](int s) {
+			BellmanFordQueueSP<DiGraph> sp(d.directed, s);
+			sink = sp.DistanceTo(sources.front());
+		}));
+	if(selected("ContractionHierarchy") && arcs <= opt.chLimit) {
+		// le pretraitement est long: une seule mesure, sans echauffement
+		Options once = opt;
+		once.warmup = 0;
+		once.repetitions = 1;
+		results.push_back(measure("ContractionHierarchy", d, arcs, { sources.front() }, once, [&](int) {
+			sink = ContractionHierarchy<DiGraph>(d.directed).Shortcuts();
+		}));
+	}
+
+	typedef MinimumSpanningTree<Graph> MST;
+	if(selected("Kruskal"))
+		results.push_back(measure("Kruskal", d, edges, noSource, opt, [&](int) {
+			sink = double(MST::Kruskal(d.undirected).size());
+		}, [&](int) {
+			CountingInstrumentation instrumentation;
+			MST::Kruskal(d.undirected, instrumentation);
+			return instrumentation.Stats();
+		}));
+	if(selected("EagerPrim"))
+		results.push_back(measure("EagerPrim", d, edges, noSource, opt, [&](int) {
+			sink = double(MST::EagerPrim(d.undirected).size());
+		}, [&](int) {
+			CountingInstrumentation instrumentation;
+			MST::EagerPrim<4>(d.undirected, instrumentation);
+			return instrumentation.Stats();
+		}));
+	if(selected("FilterKruskal"))
+		results.push_back(measure("FilterKruskal", d, edges, noSource, opt, [&](int) {
+			sink = double(MST::FilterKruskal(d.undirected).size());
+		}));
+	if(selected("Boruvka"))
+		results.push_back(measure("Boruvka", d, edges, noSource, opt, [&](int) {
+			sink = double(MST::Boruvka(d.undirected).size());
+		}));
+}
+
+string jsonString(const string& s) {
+	string out = "\"";
+	for(char c : s) {
+		if(c == '"' || c == '\\') out += '\\';
+		out += c;
+	}
+	return out + "\"";
+}
+
+void writeJSON(ostream& out, const Options& opt, const vector<Result>& results) {
+	out << "{\n";
+	out << "  \"warmup\": " << opt.warmup << ",\n";
+	out << "  \"repetitions\": " << opt.repetitions << ",\n";
+	out << "  \"sources\": " << opt.sources << ",\n";
+	out << "  \"seed\": " << opt.seed << ",\n";
+	// pic de tout le processus: il ne fait que croitre et ne peut pas etre
+	// attribue a un algorithme
+	out << "  \"peak_rss_kb\": " << PeakRSS() << ",\n";
+	out << "  \"results\": [";
+	for(size_t i = 0; i < results.size(); ++i) {
+		const Result& r = results[i];
+		out << (i ? ",\n" : "\n");
+		out << "    {\"algorithm\": " << jsonString(r.algorithm)
+		    << ", \"graph\": " << jsonString(r.graph)
+		    << ", \"V\": " << r.V
+		    << ", \"E\": " << r.E
+		    << ", \"runs\": " << r.stats.runs
+		    << ", \"min_s\": " << r.stats.min
+		    << ", \"mean_s\": " << r.stats.mean
+		    << ", \"median_s\": " << r.stats.median
+		    << ", \"p95_s\": " << r.stats.p95
+		    << ", \"p99_s\": " << r.stats.p99
+		    << ", \"max_s\": " << r.stats.max
+		    << ", \"edges_per_second\": " << r.edgesPerSecond;
+		if(r.counted) {
+			const SearchStats& c = r.counters;
+			out << ", \"counters\": {\"settled\": " << c.settled
+			    << ", \"scanned\": " << c.scanned
+			    << ", \"relaxations\": " << c.relaxations
+			    << ", \"pushes\": " << c.pushes
+			    << ", \"decrease_keys\": " << c.decreaseKeys
+			    << ", \"queue_peak\": " << c.queuePeak
+			    << ", \"passes\": " << c.passes
+			    << ", \"finds\": " << c.finds
+			    << ", \"find_steps\": " << c.findSteps
+			    << ", \"find_depth_max\": " << c.findDepthMax
+			    << ", \"setup_s\": " << c.Seconds(Phase::Setup)
+			    << ", \"sort_s\": " << c.Seconds(Phase::Sort)
+			    << ", \"search_s\": " << c.Seconds(Phase::Search) << "}";
+		}
+		out << "}";
+	}
+	out << "\n  ]\n}\n";
+}
+
+Options parseOptions(int argc, char* argv[]) {
+	Options opt;
+	for(int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if(i + 1 >= argc)
+			throw invalid_argument("option sans valeur: " + arg);
+		string value = argv[++i];
+		if(arg == "--data") opt.data = value;
+		else if(arg == "--output") opt.output = value;
+		else if(arg == "--warmup") opt.warmup = stoi(value);
+		else if(arg == "--repetitions") opt.repetitions = stoi(value);
+		else if(arg == "--sources") opt.sources = stoi(value);
+		else if(arg == "--seed") opt.seed = unsigned(stoul(value));
+		else if(arg == "--edges") opt.edges = stoi(value);
+		else if(arg == "--bf-limit") opt.bfLimit = stoi(value);
+		else if(arg == "--ch-limit") opt.chLimit = stoi(value);
+		else if(arg == "--filter") opt.filter = value;
+		else throw invalid_argument("option inconnue: " + arg);
+	}
+	if(opt.repetitions < 1 || opt.sources < 1 || opt.warmup < 0 || opt.edges < 16)
+		throw invalid_argument("--repetitions, --sources et --edges doivent etre positifs");
+	return opt;
+}
+
+int main(int argc, char* argv[]) {
+	Options opt;
+	try {
+		opt = parseOptions(argc, argv);
+	} catch(const exception& e) {
+		cerr << e.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<Result> results;
+	// les graphes sont charges ou generes un a un et hors des mesures
+	for(const char* file : { "tinyEWD.txt", "mediumEWD.txt", "1000EWD.txt", "10000EWD.txt" }) {
+		string path = opt.data + "/" + file;
+		cerr << "Loading " << path << endl;
+		Dataset d{ file, EWDReader::ReadDiGraph<double>(path), EWDReader::ReadGraph<double>(path) };
+		benchDataset(d, opt, results);
+	}
+
+	// graphes synthetiques d'environ opt.edges aretes
+	using namespace GraphGenerator;
+	ThreadPool pool;
+	int side = max(2, int(sqrt(opt.edges / 2.0)));
+	int scale = max(1, int(lround(log2(opt.edges / 16.0))));
+	TrainNetwork tn(opt.data + "/reseau.txt");
+	cerr << "Generating synthetic graphs" << endl;
+	benchDataset(makeDataset("grid", Grid(side, side, 0.5, opt.seed, pool), false), opt, results);
+	benchDataset(makeDataset("geometric", RandomGeometric(opt.edges / 4, 8, opt.seed, pool), false), opt, results);
+	benchDataset(makeDataset("rmat", RMAT(scale, 16, opt.seed, pool), true), opt, results);
+	benchDataset(makeDataset("rail", RailLike(int(opt.edges / 1.3), Profile(tn), opt.seed, pool), false), opt, results);
+
+	if(opt.output.empty())
+		writeJSON(cout, opt, results);
+	else {
+		ofstream out(opt.output);
+		writeJSON(out, opt, results);
+	}
+	return EXIT_SUCCESS;
+}
@@ -10,14 +10,35 @@
 
 #include <cstdlib>
 #include <iostream>
-#include <ctime>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <random>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+#include <array>
 
 #include "TrainNetwork.h"
 #include "MinimumSpanningTree.h"
 #include "ShortestPath.h"
+#include "ParallelShortestPath.h"
+#include "PointToPointSP.h"
+#include "LandmarkSP.h"
+#include "ContractionHierarchy.h"
+#include "ParetoSP.h"
+#include "DynamicShortestPath.h"
+#include "DynamicMST.h"
+#include "GraphAnalysis.h"
+#include "Benchmark.h"
+#include "GraphGenerator.h"
+#include "RouteExecutor.h"
 
 #include "EdgeWeightedGraph.h"
 #include "EdgeWeightedDiGraph.h"
+#include "CSRGraph.h"
+#include "EWDReader.h"
+#include "GraphSnapshot.h"
 
 #include "TrainGraphWrapper.h"
 
@@ -52,9 +73,9 @@ ostream & printVia(ostream & os, Path path, TrainNetwork const & tn) {
  */
 void ReseauLeMoinsCher(TrainNetwork &tn) {
 	std::vector<int> cost = {0, 3, 6, 10, 15};
-	TrainGraphWrapper tgw(tn, [&cost] (TrainNetwork::Line l)-> int { return cost.at(l.nbTracks)*l.length; });
-	//auto mst = MinimumSpanningTree<TrainGraphWrapper>::EagerPrim(tgw);
-	auto mst = MinimumSpanningTree<TrainGraphWrapper>::Kruskal(tgw);
+	CachedTrainGraphWrapper tgw(tn, [&cost] (TrainNetwork::Line const & l)-> int { return cost.at(l.nbTracks)*l.length; });
+	//auto mst = MinimumSpanningTree<CachedTrainGraphWrapper>::EagerPrim(tgw);
+	auto mst = MinimumSpanningTree<CachedTrainGraphWrapper>::Kruskal(tgw);
 	unsigned int weightTotal = 0;
 	for(auto const & i : mst) {
 		weightTotal += i.Weight();
@@ -74,10 +95,11 @@ void ReseauLeMoinsCher(TrainNetwork &tn) {
  * @param tn, réseau de trains et de lignes complet
  */
 void PlusCourtChemin(const string& depart, const string& arrivee, TrainNetwork& tn) {
-	TrainDiGraphWrapper tgw(tn, [] (TrainNetwork::Line l)-> int { return l.length; });
-	DijkstraSP<TrainDiGraphWrapper> referenceSP(tgw,tn.cityIdx[depart]);
-	cout << "  longueur = " << referenceSP.DistanceTo(tn.cityIdx[arrivee]) << " km" << endl;
-	printVia(cout, referenceSP.PathTo(tn.cityIdx[arrivee]), tn);
+	CachedTrainDiGraphWrapper tgw(tn, [] (TrainNetwork::Line const & l)-> int { return l.length; });
+	BidirectionalDijkstraSP<CachedTrainDiGraphWrapper> sp(tgw);
+	auto route = sp.Query(tn.cityIdx[depart], tn.cityIdx[arrivee]);
+	cout << "  longueur = " << route.distance << " km" << endl;
+	printVia(cout, route.path, tn);
 }
 
 
@@ -90,20 +112,27 @@ void PlusCourtChemin(const string& depart, const string& arrivee, TrainNetwork&
  * @param arrivee, Ville d'arrivée
  * @param gareEnTravaux, gare où les travaux ont lieu
  * @param tn, réseau de trains et de lignes complet
+ * @param analyses, analyses de connexite du reseau, gardees d'un appel a l'autre
  */
-void PlusCourtCheminAvecTravaux(const string& depart, const string& arrivee, const string& gareEnTravaux, TrainNetwork& tn) {
-	int idGareEnTravaux = tn.cityIdx.at(gareEnTravaux);
-
-	TrainDiGraphWrapper tgw(tn, [idGareEnTravaux] (TrainNetwork::Line l)-> int {
-			if(l.cities.first == idGareEnTravaux or l.cities.second == idGareEnTravaux)
-				return std::numeric_limits<int>::max();
-			else
-				return l.length; 
-			});
-	DijkstraSP<TrainDiGraphWrapper> referenceSP(tgw,tn.cityIdx[depart]);
-	cout << "  longueur = " << referenceSP.DistanceTo(tn.cityIdx[arrivee]) << " km" << endl;
-	printVia(cout, referenceSP.PathTo(tn.cityIdx[arrivee]), tn);
+void PlusCourtCheminAvecTravaux(const string& depart, const string& arrivee, const string& gareEnTravaux, TrainNetwork& tn,
+                                TrainNetworkAnalysis& analyses) {
+	int idTravaux = tn.cityIdx.at(gareEnTravaux);
+	int idArrivee = tn.cityIdx.at(arrivee);
+	// on verifie que la fermeture de la gare ne coupe pas le reseau entre
+	// depart et arrivee avant de lancer la recherche: en O(1) si la gare
+	// n'est pas un point d'articulation, l'analyse du reseau etant calculee
+	// une seule fois
+	if(!analyses.ConnectedWithout("longueur", [] (TrainNetwork::Line const & l)-> int { return l.length; },
+	                              tn.cityIdx.at(depart), idArrivee, idTravaux)) {
+		cout << "  aucun chemin: la fermeture de " << gareEnTravaux << " coupe le reseau" << endl;
+		return;
+	}
 
+	CachedTrainDiGraphWrapper tgw(tn, [] (TrainNetwork::Line const & l)-> int { return l.length; });
+	DynamicSP<CachedTrainDiGraphWrapper> sp(tgw, tn.cityIdx.at(depart));
+	sp.Block(idTravaux);
+	cout << "  longueur = " << sp.DistanceTo(idArrivee) << " km" << endl;
+	printVia(cout, sp.PathTo(idArrivee), tn);
 }
 
 
@@ -116,17 +145,199 @@ void PlusCourtCheminAvecTravaux(const string& depart, const string& arrivee, con
  * @param tn, réseau de trains et de lignes complet
  */
 void PlusRapideChemin(const string& depart, const string& arrivee, const string& via, TrainNetwork& tn) {
-	TrainDiGraphWrapper tgw(tn, [] (TrainNetwork::Line l)-> int { return l.duration; });
-	DijkstraSP<TrainDiGraphWrapper> part1(tgw,tn.cityIdx[depart]);
-	DijkstraSP<TrainDiGraphWrapper> part2(tgw,tn.cityIdx[via]);
-	auto tot = part1.DistanceTo(tn.cityIdx[via]) + part2.DistanceTo(tn.cityIdx[arrivee]);
+	CachedTrainDiGraphWrapper tgw(tn, [] (TrainNetwork::Line const & l)-> int { return l.duration; });
+	ContractionHierarchy<CachedTrainDiGraphWrapper> sp(tgw);
+	ContractionHierarchy<CachedTrainDiGraphWrapper>::Workspace workspace;
+	auto part1 = sp.Query(tn.cityIdx[depart], tn.cityIdx[via], workspace);
+	auto part2 = sp.Query(tn.cityIdx[via], tn.cityIdx[arrivee], workspace);
+	auto tot = part1.distance + part2.distance;
 	cout << "  temps = " << tot << " minutes" << endl;
-	auto path = part1.PathTo(tn.cityIdx[via]);
-	auto path2 = part2.PathTo(tn.cityIdx[arrivee]);
-	path.insert(path.end(), path2.begin(), path2.end());
+	auto path = part1.path;
+	path.insert(path.end(), part2.path.begin(), part2.path.end());
 	printVia(cout, path, tn);
 }
 
+/**
+ * @brief Calcule et affiche les chemins de la ville depart a la ville arrivee
+ *        offrant les meilleurs compromis entre la distance, la duree et le cout
+ *        (meme cout au km que ReseauLeMoinsCher): aucun autre chemin n'est
+ *        meilleur sur les trois criteres a la fois.
+ * @param depart, Ville de départ
+ * @param arrivee, Ville d'arrivée
+ * @param tn, réseau de trains et de lignes complet
+ */
+void CompromisChemin(const string& depart, const string& arrivee, TrainNetwork& tn) {
+	std::vector<int> cost = {0, 3, 6, 10, 15};
+	ParetoSP<3> sp(tn, [&cost] (TrainNetwork::Line const & l) {
+		return ParetoSP<3>::Costs{ l.length, l.duration, cost.at(l.nbTracks)*l.length };
+	});
+	for(auto const & route : sp.Query(tn.cityIdx.at(depart), tn.cityIdx.at(arrivee))) {
+		cout << "  longueur = " << route.costs[0] << " km, temps = " << route.costs[1]
+		     << " minutes, cout = " << route.costs[2] << " MF" << endl;
+		printVia(cout, route.path, tn);
+	}
+}
+
+
+// compare les distances calculees par testSP a celles de referenceSP
+// pour tous les sommets. Affiche le premier sommet en desaccord.
+template<typename SPRef, typename SPTest>
+bool compareShortestPath(const SPRef& referenceSP, const SPTest& testSP, int V)
+{
+    for (int v=0; v<V; ++v) {
+        if (referenceSP.DistanceTo(v) != testSP.DistanceTo(v) ) {
+            cout << "Oops: vertex" << v << " has " << referenceSP.DistanceTo(v) << " != " <<  testSP.DistanceTo(v) << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// verifie que PathTo(v) de sp part de source, que chaque arc part de
+// l'extremite du precedent, que le chemin arrive a v et que son poids est
+// DistanceTo(v). Sans cycle negatif, PathTo doit etre vide exactement pour
+// les sommets non atteints (et la source).
+template<typename SP>
+bool checkPathTo(const string& name, const SP& sp, int V, int source)
+{
+    for (int v = 0; v < V; ++v) {
+        auto path = sp.PathTo(v);
+        bool ok = path.empty() == (v == source || !sp.HasPathTo(v));
+        double weight = 0;
+        for (size_t i = 0; ok && i < path.size(); ++i) {
+            weight += path[i].Weight();
+            ok = path[i].From() == (i ? path[i-1].To() : source);
+        }
+        ok = ok && (path.empty() || path.back().To() == v);
+        if (ok && sp.HasPathTo(v))
+            ok = std::abs(weight - sp.DistanceTo(v)) <= 1e-9 * std::max(1.0, std::abs(weight));
+        if (!ok) {
+            cout << "Oops: " << name << " PathTo(" << v << ") is not a shortest path" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// calcule les plus courts chemins au sommet 0 avec l'algorithme SP, affiche
+// le temps de calcul sous le nom name et compare le resultat a referenceSP.
+template<typename SP, typename Graph, typename SPRef>
+bool testShortestPathAlgo(const string& name, const Graph& ewd, const SPRef& referenceSP)
+{
+    Stopwatch watch;
+
+    SP testSP(ewd,0);
+
+    cout << name << watch.Seconds() << " seconds." << endl;
+
+    return compareShortestPath(referenceSP, testSP, ewd.V());
+}
+
+// ouvre la sauvegarde binaire filename.csr du graphe defini par filename,
+// en la creant si elle n'existe pas, n'est pas valide ou est plus ancienne
+// que filename (le fichier texte a ete modifie depuis). Les deux temps
+// affiches sont celui de l'ouverture avec somme de controle, qui lit tout
+// le fichier (absent si la sauvegarde est recreee), puis celui d'une
+// ouverture simple, le fichier etant alors dans le cache du systeme.
+CSRDiGraph<double> openSnapshot(const string& filename)
+{
+    namespace fs = std::filesystem;
+    string snapshotFile = filename + ".csr";
+    bool stale = !fs::exists(snapshotFile)
+              || fs::last_write_time(snapshotFile) < fs::last_write_time(filename);
+    if (!stale) {
+        try {
+            Stopwatch watch;
+            GraphSnapshot::OpenDiGraph<double>(snapshotFile, true);
+            cout << "Lecture snap:   " << watch.Seconds() << " seconds, somme de controle comprise." << endl;
+        } catch(const std::runtime_error&) {
+            stale = true;
+        }
+    }
+    if (stale)
+        GraphSnapshot::ConvertEWD<double>(filename, snapshotFile);
+
+    Stopwatch watch;
+
+    CSRDiGraph<double> g = GraphSnapshot::OpenDiGraph<double>(snapshotFile);
+
+    cout << "Ouverture snap: " << watch.Seconds() << " seconds, fichier en cache, structure verifiee." << endl;
+    return g;
+}
+
+// verifie que delta-stepping donne les memes arcs EdgeTo, et pas seulement
+// les memes distances, quel que soit le nombre de threads, y compris quand
+// deux arcs menent a un sommet a la meme distance.
+void testDeltaSteppingThreads(string filename)
+{
+    cout << "Testing delta-stepping threads " << filename << endl;
+
+    typedef EdgeWeightedDiGraph<double> Graph;
+    Graph ties(4);
+    ties.addEdge(0, 2, 1.0);
+    ties.addEdge(0, 1, 1.0);
+    ties.addEdge(1, 3, 1.0);
+    ties.addEdge(2, 3, 1.0);
+    Graph ewd(filename);
+
+    bool ok = true;
+    ThreadPool single(1);
+    DeltaSteppingSP<Graph> tiesReference(ties, 0, single, 1.0);
+    DeltaSteppingSP<Graph> reference(ewd, 0, single);
+    for (unsigned threads : { 2u, 4u }) {
+        ThreadPool pool(threads);
+        for (auto test : { std::make_pair(&ties, &tiesReference), std::make_pair(&ewd, &reference) }) {
+            const Graph& g = *test.first;
+            DeltaSteppingSP<Graph> sp(g, 0, pool, test.second->Delta());
+            for (int v = 0; ok && v < g.V(); ++v)
+                if (sp.HasPathTo(v) && sp.EdgeTo(v).From() != test.second->EdgeTo(v).From()) {
+                    cout << "Oops: EdgeTo(" << v << ") differs with " << threads << " threads" << endl;
+                    ok = false;
+                }
+        }
+    }
+    if (ok && tiesReference.EdgeTo(3).From() != 1) {
+        cout << "Oops: tie not broken by the smallest origin" << endl;
+        ok = false;
+    }
+    ok = ok && checkPathTo("Delta-step", reference, ewd.V(), 0);
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// compare les distances des recherches point a point de testSP depuis le
+// sommet 0 a celles de referenceSP, pour un echantillon de destinations.
+// Les chemins peuvent etre additionnes dans un autre ordre, on tolere donc
+// une erreur d'arrondi. Toutes les recherches partagent le meme espace de
+// travail, et doivent donner le meme chemin qu'avec un espace neuf.
+template<typename P2P, typename SPRef>
+bool comparePointToPoint(const string& name, const P2P& testSP, const SPRef& referenceSP, int V)
+{
+    Stopwatch watch;
+    long settled = 0;
+    bool ok = true;
+    typename P2P::Workspace workspace;
+
+    for (int v=0; v<V && ok; v += 1 + V/100) {
+        auto route = testSP.Query(0, v, workspace);
+        settled += route.settled;
+        auto fresh = testSP.Query(0, v);
+        if (route.distance != fresh.distance || route.path.size() != fresh.path.size()
+            || route.settled != fresh.settled) {
+            cout << "Oops: vertex " << v << " differs with a reused workspace" << endl;
+            ok = false;
+        }
+        double d = referenceSP.DistanceTo(v);
+        if (route.found != (d != std::numeric_limits<double>::max())
+            || (route.found && std::abs(route.distance - d) > 1e-9 * std::max(1.0, d))) {
+            cout << "Oops: vertex" << v << " has " << referenceSP.DistanceTo(v) << " != " <<  route.distance << endl;
+            ok = false;
+        }
+    }
+
+    cout << name << watch.Seconds() << " seconds, "
+         << settled << " sommets fixes." << endl;
+    return ok;
+}
 
 // compare les algorithmes Dijkstra et BellmanFord pour calculer les plus courts chemins au
 // sommet 0 dans le graphe defini par filename.
@@ -137,27 +348,1006 @@ void testShortestPath(string filename)
     bool ok = true;
 
     typedef EdgeWeightedDiGraph<double> Graph;
+
+    Stopwatch watch;
+
     Graph ewd(filename);
 
-    clock_t startTime = clock();
+    cout << "Lecture stream: " << watch.Seconds() << " seconds." << endl;
+    watch.Restart();
+
+    CSRDiGraph<double> csr = EWDReader::ReadDiGraph<double>(filename);
+
+    cout << "Lecture mmap:   " << watch.Seconds() << " seconds." << endl;
+
+    CSRDiGraph<double> snapshot = openSnapshot(filename);
+
+    watch.Restart();
 
     BellmanFordSP<Graph> referenceSP(ewd,0);
 
-    cout << "Bellman-Ford: " << double( clock() - startTime ) / (double)CLOCKS_PER_SEC<< " seconds." << endl;
-    startTime = clock();
+    cout << "Bellman-Ford: " << watch.Seconds() << " seconds." << endl;
 
-    DijkstraSP<Graph> testSP(ewd,0);
+    ok = testShortestPathAlgo<BellmanFordQueueSP<Graph>>("BF queue:     ", ewd, referenceSP) && ok;
 
+    ThreadPool pool;
+    watch.Restart();
 
-    cout << "Dijkstra:     " << double( clock() - startTime ) / (double)CLOCKS_PER_SEC<< " seconds." << endl;
+    ParallelBellmanFordSP<Graph> parallelSP(ewd,0,pool);
 
-    for (int v=0; v<ewd.V(); ++v) {
-        if (referenceSP.DistanceTo(v) != testSP.DistanceTo(v) ) {
-            cout << "Oops: vertex" << v << " has " << referenceSP.DistanceTo(v) << " != " <<  testSP.DistanceTo(v) << endl;
+    cout << "BF parallel:  " << watch.Seconds() << " seconds." << endl;
+    ok = compareShortestPath(referenceSP, parallelSP, ewd.V()) && ok;
+
+    watch.Restart();
+
+    DeltaSteppingSP<Graph> deltaSP(ewd,0,pool);
+
+    cout << "Delta-step:   " << watch.Seconds() << " seconds." << endl;
+    ok = compareShortestPath(referenceSP, deltaSP, ewd.V()) && ok;
+
+    // avec un delta minuscule, le nombre de cases est limite a V et les
+    // seaux ulterieurs partagent les cases des seaux courants
+    DeltaSteppingSP<Graph> smallDeltaSP(ewd,0,pool,deltaSP.Delta() / ewd.V());
+    ok = compareShortestPath(referenceSP, smallDeltaSP, ewd.V()) && ok;
+
+    ok = testShortestPathAlgo<DijkstraSP<Graph>>    ("Dijkstra:     ", ewd, referenceSP) && ok;
+    ok = testShortestPathAlgo<DijkstraSP<Graph,4>>  ("Dijkstra D=4: ", ewd, referenceSP) && ok;
+    ok = testShortestPathAlgo<DijkstraSP<Graph,8>>  ("Dijkstra D=8: ", ewd, referenceSP) && ok;
+    ok = testShortestPathAlgo<DijkstraLazySP<Graph>>("Dijkstra lazy:", ewd, referenceSP) && ok;
+
+    ok = testShortestPathAlgo<DijkstraSP<CSRDiGraph<double>>>("Dijkstra CSR: ", csr, referenceSP) && ok;
+    ok = testShortestPathAlgo<DijkstraSP<CSRDiGraph<double>>>("Dijkstra snap:", snapshot, referenceSP) && ok;
+
+    BidirectionalDijkstraSP<Graph> bidirectionalSP(ewd);
+    ok = comparePointToPoint("Bidirectional:", bidirectionalSP, referenceSP, ewd.V()) && ok;
+
+    ALTSP<Graph> altSP(ewd);
+    ok = comparePointToPoint("ALT:          ", altSP, referenceSP, ewd.V()) && ok;
+
+    watch.Restart();
+    ContractionHierarchy<Graph> ch(ewd);
+    cout << "CH build:     " << watch.Seconds() << " seconds, "
+         << ch.Shortcuts() << " raccourcis." << endl;
+    ok = comparePointToPoint("CH:           ", ch, referenceSP, ewd.V()) && ok;
+
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+
+
+// ecrit le graphe defini par filename en snapshot, corrompt un sommet puis un
+// offset sans changer la taille du fichier: l'ouverture, meme sans
+// verification de la somme de controle, doit echouer.
+void testCorruptSnapshot(string filename)
+{
+    cout << "Testing corrupt snapshot " << filename << endl;
+
+    CSRDiGraph<double> g = EWDReader::ReadDiGraph<double>(filename);
+    string snapshotFile = filename + ".corrupt.csr";
+    GraphSnapshot::Layout layout(g.V(), g.Entries(), sizeof(double));
+
+    bool ok = true;
+    struct Corruption { size_t position; int32_t value; };
+    for (Corruption c : { Corruption{ layout.targets, g.V() },
+                          Corruption{ layout.targets, -1 },
+                          Corruption{ layout.offsets + sizeof(int32_t), g.Entries() + 1 } }) {
+        GraphSnapshot::Write(g, snapshotFile);
+        {
+            std::fstream f(snapshotFile, std::ios::binary | std::ios::in | std::ios::out);
+            f.seekp(std::streamoff(c.position));
+            f.write(reinterpret_cast<const char*>(&c.value), sizeof(c.value));
+        }
+        try {
+            GraphSnapshot::OpenDiGraph<double>(snapshotFile);
+            cout << "Oops: corrupt snapshot accepted" << endl;
+            ok = false;
+        } catch (const std::runtime_error&) {
+        }
+    }
+    std::remove(snapshotFile.c_str());
+
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// compare le front de Pareto (longueur, duree, cout) de ParetoSP a Dijkstra
+// sur chaque critere: le minimum du front pour un critere est la distance de
+// Dijkstra. Verifie aussi que les chemins du front ne se dominent pas, que
+// leurs poids sont la somme de ceux de leurs lignes, et que le front tronque
+// par maxLabels ne contient que des chemins valides domines par le front
+// complet.
+void testParetoSP(TrainNetwork& tn)
+{
+    cout << "Testing Pareto" << endl;
+
+    typedef ParetoSP<3> SP;
+    std::vector<int> cost = {0, 3, 6, 10, 15};
+    auto fnCosts = [&cost] (TrainNetwork::Line const & l) {
+        return SP::Costs{ l.length, l.duration, cost.at(l.nbTracks)*l.length };
+    };
+    SP sp(tn, fnCosts);
+    SP truncated(tn, fnCosts, 2);
+    std::vector<CachedTrainDiGraphWrapper> graphs;
+    for (int k = 0; k < 3; ++k)
+        graphs.emplace_back(tn, [&] (TrainNetwork::Line const & l)-> int { return fnCosts(l)[k]; });
+
+    auto dominates = [] (const SP::Costs& a, const SP::Costs& b) {
+        for (int k = 0; k < 3; ++k)
+            if (a[k] > b[k]) return false;
+        return true;
+    };
+    // le chemin va de s a t et ses poids sont la somme de ceux de ses lignes
+    auto valid = [&] (const SP::ParetoRoute& r, int s, int t) {
+        SP::Costs sum = {0, 0, 0};
+        int at = s;
+        for (size_t i = 0; i < r.path.size(); ++i) {
+            const TrainNetwork::Line& line = tn.lines[r.lines[i]];
+            if (r.path[i].From() != at
+                || !((line.cities.first == at && line.cities.second == r.path[i].To())
+                  || (line.cities.second == at && line.cities.first == r.path[i].To())))
+                return false;
+            for (int k = 0; k < 3; ++k) sum[k] += fnCosts(line)[k];
+            at = r.path[i].To();
+        }
+        return at == t && sum == r.costs;
+    };
+
+    Stopwatch watch;
+    bool ok = true;
+    long routes = 0, truncatedFronts = 0;
+    int C = int(tn.cities.size());
+    for (int s = 0; ok && s < C; s += 3) {
+        std::vector<DijkstraSP<CachedTrainDiGraphWrapper>> reference;
+        for (int k = 0; k < 3; ++k)
+            reference.emplace_back(graphs[k], s);
+        for (int t = 0; ok && t < C; ++t) {
+            std::vector<SP::ParetoRoute> front = sp.Query(s, t);
+            routes += front.size();
+            bool reachable = reference[0].HasPathTo(t);
+            if (front.empty() == reachable) {
+                cout << "Oops: " << tn.cities[s].name << " -> " << tn.cities[t].name << " reachability" << endl;
+                ok = false;
+                break;
+            }
+            for (int k = 0; reachable && k < 3; ++k) {
+                int best = numeric_limits<int>::max();
+                for (auto const & r : front) best = std::min(best, r.costs[k]);
+                if (best != reference[k].DistanceTo(t)) {
+                    cout << "Oops: " << tn.cities[s].name << " -> " << tn.cities[t].name << " criterion " << k
+                         << " gives " << best << " != " << reference[k].DistanceTo(t) << endl;
+                    ok = false;
+                }
+            }
+            for (size_t i = 0; i < front.size(); ++i) {
+                if (!valid(front[i], s, t)) {
+                    cout << "Oops: invalid route " << tn.cities[s].name << " -> " << tn.cities[t].name << endl;
+                    ok = false;
+                }
+                for (size_t j = 0; j < front.size(); ++j)
+                    if (i != j && dominates(front[i].costs, front[j].costs)) {
+                        cout << "Oops: dominated route " << tn.cities[s].name << " -> " << tn.cities[t].name << endl;
+                        ok = false;
+                    }
+            }
+
+            std::vector<SP::ParetoRoute> partial = truncated.Query(s, t);
+            if (front.size() > 2) ++truncatedFronts;
+            if (partial.empty() == reachable || partial.size() > 2) {
+                cout << "Oops: truncated front " << tn.cities[s].name << " -> " << tn.cities[t].name << endl;
+                ok = false;
+            }
+            for (auto const & r : partial) {
+                bool covered = false;
+                for (auto const & f : front) covered = covered || dominates(f.costs, r.costs);
+                if (!valid(r, s, t) || !covered) {
+                    cout << "Oops: truncated route " << tn.cities[s].name << " -> " << tn.cities[t].name << endl;
+                    ok = false;
+                }
+            }
+        }
+    }
+    cout << "Pareto:       " << watch.Seconds() << " seconds, " << routes << " chemins." << endl;
+    if (ok && truncatedFronts == 0) {
+        cout << "Oops: maxLabels never truncated a front" << endl;
+        ok = false;
+    }
+
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// verifie que TrainNetworkAnalysis garde ses analyses en memoire et que
+// ConnectedWithout repond comme une analyse complete du reseau prive de la
+// gare fermee, pour toutes les gares et toutes les paires de villes.
+void testTrainNetworkAnalysis(TrainNetwork& tn)
+{
+    cout << "Testing train network analysis" << endl;
+
+    auto length = [] (TrainNetwork::Line const & l)-> int { return l.length; };
+    TrainNetworkAnalysis analyses(tn);
+    int C = int(tn.cities.size());
+    bool ok = true;
+
+    const TrainNetworkAnalysis::Analysis& base = analyses.Get("longueur", length);
+    if (!analyses.Contains("longueur") || &analyses.Get("longueur", length) != &base) {
+        cout << "Oops: analysis is not cached" << endl;
+        ok = false;
+    }
+
+    int articulations = 0;
+    for (int closed = 0; ok && closed < C; ++closed) {
+        if (base.IsArticulationPoint(closed)) ++articulations;
+        GraphAnalysis<CachedTrainGraphWrapper> reference(CachedTrainGraphWrapper(tn, [&] (TrainNetwork::Line const & l)-> int {
+            if (l.cities.first == closed || l.cities.second == closed) return numeric_limits<int>::max();
+            return l.length;
+        }));
+        for (int s = 0; ok && s < C; ++s)
+            for (int t = 0; ok && t < C; ++t) {
+                bool expected = s != closed && t != closed && reference.Connected(s, t);
+                if (analyses.ConnectedWithout("longueur", length, s, t, closed) != expected) {
+                    cout << "Oops: " << tn.cities[s].name << " - " << tn.cities[t].name << " without "
+                         << tn.cities[closed].name << " should be " << expected << endl;
+                    ok = false;
+                }
+            }
+        // seuls les points d'articulation donnent une analyse supplementaire
+        if (analyses.Contains("longueur/" + std::to_string(closed)) != base.IsArticulationPoint(closed)) {
+            cout << "Oops: unexpected analysis for " << tn.cities[closed].name << endl;
+            ok = false;
+        }
+    }
+    cout << "  " << articulations << " points d'articulation" << endl;
+
+    analyses.Invalidate("longueur");
+    for (int closed = 0; closed < C; ++closed)
+        if (analyses.Contains("longueur") || analyses.Contains("longueur/" + std::to_string(closed))) {
+            cout << "Oops: analysis not invalidated" << endl;
             ok = false;
             break;
         }
+
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// arcs ou aretes d'un graphe du reseau ferroviaire, tries, vus par
+// forEachEdge (adjacent faux) ou par forEachAdjacentEdge de chaque ville
+// (adjacent vrai). Les aretes non orientees sont rangees (min, max, poids),
+// et chaque arete adjacente doit toucher la ville parcourue.
+template<bool Directed, typename TrainGraph>
+std::vector<std::array<int,3>> trainEdges(const TrainGraph& g, bool adjacent)
+{
+    std::vector<std::array<int,3>> edges;
+    auto add = [&edges] (int v, int w, int weight) {
+        if (!Directed && w < v) std::swap(v, w);
+        edges.push_back({ v, w, weight });
+    };
+    if (!adjacent)
+        g.forEachEdge([&] (const typename TrainGraph::Edge& e) {
+            if constexpr (Directed) add(e.From(), e.To(), e.Weight());
+            else { int v = e.Either(); add(v, e.Other(v), e.Weight()); }
+        });
+    else
+        for (int v = 0; v < g.V(); ++v)
+            g.forEachAdjacentEdge(v, [&] (const typename TrainGraph::Edge& e) {
+                if constexpr (Directed) add(e.From() == v ? v : -1, e.To(), e.Weight());
+                else add(v, e.Other(v), e.Weight());
+            });
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+// voisins de chaque ville vus par forEachAdjacentVertex, tries
+template<typename TrainGraph>
+std::vector<std::array<int,2>> trainNeighbours(const TrainGraph& g)
+{
+    std::vector<std::array<int,2>> neighbours;
+    for (int v = 0; v < g.V(); ++v)
+        g.forEachAdjacentVertex(v, [&] (int w) { neighbours.push_back({ v, w }); });
+    std::sort(neighbours.begin(), neighbours.end());
+    return neighbours;
+}
+
+// compare les wrappers qui rappellent fnWeight a chaque parcours, avec un
+// lambda (MakeTrain*Wrapper) ou std::function (Train*Wrapper), aux
+// wrappers CSR CachedTrain*Wrapper, avec et sans gare fermee.
+void testTrainGraphWrappers(TrainNetwork& tn)
+{
+    cout << "Testing train graph wrappers" << endl;
+
+    int closed = tn.cityIdx.at("Sion");
+    auto length = [] (TrainNetwork::Line const & l) { return l.length; };
+    auto duration = [closed] (TrainNetwork::Line const & l) {
+        if (l.cities.first == closed || l.cities.second == closed) return numeric_limits<int>::max();
+        return l.duration;
+    };
+
+    bool ok = true;
+    auto check = [&ok] (bool same, const string& what) {
+        if (!same) {
+            cout << "Oops: " << what << " differs from the cached wrapper" << endl;
+            ok = false;
+        }
+    };
+    auto compare = [&] (auto fnWeight) {
+        CachedTrainGraphWrapper graph(tn, fnWeight);
+        CachedTrainDiGraphWrapper digraph(tn, fnWeight);
+        auto edges = trainEdges<false>(graph, false), adjacent = trainEdges<false>(graph, true);
+        auto arcs = trainEdges<true>(digraph, false), adjacentArcs = trainEdges<true>(digraph, true);
+        auto neighbours = trainNeighbours(graph), outNeighbours = trainNeighbours(digraph);
+
+        auto g = MakeTrainGraphWrapper(tn, fnWeight);
+        TrainGraphWrapper gf(tn, fnWeight);
+        check(trainEdges<false>(g, false) == edges && trainEdges<false>(gf, false) == edges,
+              "TrainGraphWrapper::forEachEdge");
+        check(trainEdges<false>(g, true) == adjacent && trainEdges<false>(gf, true) == adjacent,
+              "TrainGraphWrapper::forEachAdjacentEdge");
+        check(trainNeighbours(g) == neighbours && trainNeighbours(gf) == neighbours,
+              "TrainGraphWrapper::forEachAdjacentVertex");
+
+        auto dg = MakeTrainDiGraphWrapper(tn, fnWeight);
+        TrainDiGraphWrapper dgf(tn, fnWeight);
+        check(trainEdges<true>(dg, false) == arcs && trainEdges<true>(dgf, false) == arcs,
+              "TrainDiGraphWrapper::forEachEdge");
+        check(trainEdges<true>(dg, true) == adjacentArcs && trainEdges<true>(dgf, true) == adjacentArcs,
+              "TrainDiGraphWrapper::forEachAdjacentEdge");
+        check(trainNeighbours(dg) == outNeighbours && trainNeighbours(dgf) == outNeighbours,
+              "TrainDiGraphWrapper::forEachAdjacentVertex");
+    };
+    compare(length);
+    compare(duration);
+
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// sauvegarde le reseau ferroviaire avec ConvertTrainNetwork, avec et sans
+// gare fermee, et compare le graphe relu a CachedTrainDiGraphWrapper.
+void testTrainSnapshot(TrainNetwork& tn)
+{
+    cout << "Testing train network snapshot" << endl;
+
+    typedef CachedTrainDiGraphWrapper::WeightType Weight;
+    string snapshotFile = "reseau.txt.csr";
+    int closed = tn.cityIdx.at("Sion");
+    std::vector<std::function<int(const TrainNetwork::Line&)>> weights = {
+        [] (TrainNetwork::Line const & l) { return l.length; },
+        [closed] (TrainNetwork::Line const & l) {
+            if (l.cities.first == closed || l.cities.second == closed) return numeric_limits<int>::max();
+            return l.duration;
+        }
+    };
+
+    bool ok = true;
+    for (auto const & fnWeight : weights) {
+        GraphSnapshot::ConvertTrainNetwork(tn, snapshotFile, fnWeight);
+        CSRDiGraph<Weight> snapshot = GraphSnapshot::OpenDiGraph<Weight>(snapshotFile, true);
+        CachedTrainDiGraphWrapper reference(tn, fnWeight);
+        int V = reference.V(), E = reference.Entries();
+        if (snapshot.V() != V || snapshot.Entries() != E
+            || !std::equal(reference.Offsets(), reference.Offsets() + V + 1, snapshot.Offsets())
+            || !std::equal(reference.Targets(), reference.Targets() + E, snapshot.Targets())
+            || !std::equal(reference.Weights(), reference.Weights() + E, snapshot.Weights())) {
+            cout << "Oops: train network snapshot differs" << endl;
+            ok = false;
+        }
     }
+    std::remove(snapshotFile.c_str());
+
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// verifie que EWDReader refuse les fichiers mal formes au lieu d'ecrire
+// hors de ses tableaux
+void testMalformedEWD()
+{
+    cout << "Testing malformed EWD" << endl;
+
+    bool ok = true;
+    for (string text : { "3\n2\n0 1 1.0 2 0 0.5\n1 2 1.0\n",   // ligne de 6 nombres
+                         "3\n1\n0 1 1.0 1 2 0.5\n",             // plus d'arcs que de lignes
+                         "9\n3\n0 1\n2 3 4 5\n6 7 8\n",            // arcs a cheval sur les lignes
+                         "3\n2\n0 1\n1 2 1.0\n",                // ligne de 2 nombres
+                         "3\n1\n0 1 1.0x\n",                    // caracteres apres le poids
+                         "-3\n0\n",
+                         "3\n-1\n",
+                         "3\n1\n0 3 1.0\n" }) {
+        for (unsigned threads : { 1u, 2u }) {
+            try {
+                EWDReader::ParseEdges<double>(text.data(), text.size(), threads);
+                cout << "Oops: accepted \"" << text << "\"" << endl;
+                ok = false;
+            } catch (const std::runtime_error&) {
+            }
+        }
+    }
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// sauvegarde les tables ALT du graphe defini par filename, puis modifie le
+// poids d'un arc: les tables sauvegardees ne doivent plus etre relues, mais
+// recalculees, et les chemins trouves doivent rester les plus courts.
+void testLandmarkTables(string filename)
+{
+    cout << "Testing ALT tables " << filename << endl;
+
+    typedef CSRDiGraph<double> Graph;
+    string tableFile = filename + ".alt";
+    EWDReader::EdgeArrays<double> a = EWDReader::ReadEdges<double>(filename);
+    Graph g(Graph::BuildStorage(a.V, a.from, a.to, a.weight, false));
+    ALTSP<Graph> saved(g, tableFile, 4);
+
+    // un raccourci rend les anciennes bornes non admissibles
+    a.weight[a.weight.size() / 2] = 0;
+    Graph modified(Graph::BuildStorage(a.V, a.from, a.to, a.weight, false));
+
+    bool ok = true;
+    ALTSP<Graph> probe(modified, 4);
+    if (probe.Load(tableFile)) {
+        cout << "Oops: tables of another graph were loaded" << endl;
+        ok = false;
+    }
+    ALTSP<Graph> rebuilt(modified, tableFile, 4);
+    if (!probe.Load(tableFile)) {
+        cout << "Oops: tables were not rebuilt" << endl;
+        ok = false;
+    }
+    ok = comparePointToPoint("ALT rebuilt:  ", rebuilt, DijkstraSP<Graph>(modified, 0), a.V) && ok;
+
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// applique des lots de modifications aleatoires (poids, arcs fermes, sommets
+// bloques) a DynamicSP et compare apres chaque lot ses distances a celles de
+// Dijkstra recalcule sur le graphe modifie.
+void testDynamicShortestPath(string filename)
+{
+    cout << "Testing dynamic " << filename << endl;
+
+    typedef CSRDiGraph<double> Graph;
+    typedef DynamicSP<Graph>::Change Change;
+    Graph g = EWDReader::ReadDiGraph<double>(filename);
+
+    DynamicSP<Graph> dynamicSP(g, 0);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> vertex(0, g.V()-1);
+    std::uniform_real_distribution<double> weight(0.0, 1.0);
+
+    bool ok = true;
+    long settled = 0;
+    double dynamicTime = 0, referenceTime = 0;
+    Stopwatch watch;
+    for (int batch = 0; batch < 20 && ok; ++batch) {
+        std::vector<Change> changes;
+        for (int k = 0; k < 5; ++k) {
+            int v = vertex(rng);
+            if (g.Degree(v) == 0) continue;
+            int w = g.Targets()[g.Offsets()[v] + rng() % g.Degree(v)];
+            double r = weight(rng);
+            if (r < 0.1)
+                changes.push_back(Change{Change::SetWeight, v, w, std::numeric_limits<double>::max()});
+            else
+                changes.push_back(Change{Change::SetWeight, v, w, r});
+        }
+        int b = vertex(rng);
+        changes.push_back(Change{dynamicSP.IsBlocked(b) ? Change::Unblock : Change::Block, b, -1, 0});
+
+        watch.Restart();
+        dynamicSP.ApplyBatch(changes);
+        dynamicTime += watch.Seconds();
+        settled += dynamicSP.Settled();
+
+        watch.Restart();
+        DijkstraSP<Graph> referenceSP(dynamicSP.Graph(), 0);
+        referenceTime += watch.Seconds();
+        ok = compareShortestPath(referenceSP, dynamicSP, g.V());
+    }
+
+    cout << "Dynamic:      " << dynamicTime << " seconds, "
+         << settled << " sommets fixes." << endl;
+    cout << "Recompute:    " << referenceTime << " seconds." << endl;
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// poids total d'une liste d'aretes
+template<typename EdgeList>
+double totalWeight(const EdgeList& edges)
+{
+    double total = 0;
+    for (auto const & e : edges) total += e.Weight();
+    return total;
+}
+
+// calcule l'arbre couvrant de poids minimum du graphe non oriente defini par
+// filename avec Kruskal, EagerPrim, FilterKruskal et Boruvka et compare leurs poids.
+void testMinimumSpanningTree(string filename)
+{
+    cout << "Testing MST " << filename << endl;
+
+    typedef CSRGraph<double> Graph;
+    typedef MinimumSpanningTree<Graph> MST;
+    Graph g = EWDReader::ReadGraph<double>(filename);
+
+    Stopwatch watch;
+    double reference = totalWeight(MST::Kruskal(g));
+    cout << "Kruskal:      " << watch.Seconds() << " seconds." << endl;
+
+    watch.Restart();
+    double prim = totalWeight(MST::EagerPrim(g));
+    cout << "EagerPrim:    " << watch.Seconds() << " seconds." << endl;
+
+    watch.Restart();
+    double filter = totalWeight(MST::FilterKruskal(g));
+    cout << "FilterKruskal:" << watch.Seconds() << " seconds." << endl;
+
+    ThreadPool pool;
+    watch.Restart();
+    double filterParallel = totalWeight(MST::FilterKruskal(g, pool));
+    cout << "Filter par.:  " << watch.Seconds() << " seconds." << endl;
+
+    watch.Restart();
+    MST::EdgeList boruvka = MST::Boruvka(g, pool);
+    cout << "Boruvka:      " << watch.Seconds() << " seconds." << endl;
+
+    bool ok = true;
+    for (double total : { prim, filter, filterParallel, totalWeight(boruvka) })
+        if (std::abs(total - reference) > 1e-9 * std::max(1.0, reference)) {
+            cout << "Oops: weight " << total << " != " << reference << endl;
+            ok = false;
+        }
+
+    // le resultat de Boruvka ne doit pas dependre du nombre de threads
+    ThreadPool single(1);
+    MST::EdgeList sequential = MST::Boruvka(g, single);
+    for (size_t i = 0; ok && i < std::max(boruvka.size(), sequential.size()); ++i)
+        if (i >= boruvka.size() || i >= sequential.size()
+            || boruvka[i].Either() != sequential[i].Either() || boruvka[i].Weight() != sequential[i].Weight()) {
+            cout << "Oops: Boruvka depends on the number of threads" << endl;
+            ok = false;
+        }
+
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// change le poids d'aretes aleatoires de DynamicMST sur le graphe non oriente
+// defini par filename et compare regulierement le poids de l'arbre maintenu
+// a celui calcule par Kruskal sur le graphe modifie.
+void testDynamicMST(string filename)
+{
+    cout << "Testing dynamic MST " << filename << endl;
+
+    typedef CSRGraph<double> Graph;
+    Graph g = EWDReader::ReadGraph<double>(filename);
+
+    Stopwatch watch;
+    DynamicMST<Graph> dynamicMST(g);
+    cout << "Initial:      " << watch.Seconds() << " seconds." << endl;
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> edge(0, dynamicMST.E()-1);
+    std::uniform_real_distribution<double> weight(0.0, 1.0);
+
+    bool ok = true;
+    double dynamicTime = 0, referenceTime = 0;
+    for (int round = 0; round < 10 && ok; ++round) {
+        watch.Restart();
+        for (int k = 0; k < 20; ++k) {
+            // une fois sur deux une arete de l'arbre, pour tester les augmentations
+            int e = edge(rng);
+            while (k % 2 == 0 && !dynamicMST.InTree(e)) e = edge(rng);
+            dynamicMST.SetWeight(e, weight(rng));
+        }
+        dynamicTime += watch.Seconds();
+
+        watch.Restart();
+        double reference = totalWeight(MinimumSpanningTree<Graph>::Kruskal(dynamicMST.Graph()));
+        referenceTime += watch.Seconds();
+
+        double total = totalWeight(dynamicMST.Tree());
+        if (std::abs(total - reference) > 1e-9 * std::max(1.0, reference)
+            || std::abs(dynamicMST.TotalWeight() - reference) > 1e-6 * std::max(1.0, reference)) {
+            cout << "Oops: weight " << total << " != " << reference << endl;
+            ok = false;
+        }
+    }
+
+    cout << "Dynamic:      " << dynamicTime << " seconds." << endl;
+    cout << "Kruskal:      " << referenceTime << " seconds." << endl;
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// verifie les composantes connexes, points d'articulation et ponts calcules
+// par GraphAnalysis sur un graphe non oriente et son arbre couvrant minimum.
+// Pour les petits graphes, on les compare a un calcul naif: retirer chaque
+// sommet et chaque arete et regarder si le graphe est coupe.
+template<typename Graph>
+bool checkGraphAnalysis(const Graph& g, bool bruteForce)
+{
+    GraphAnalysis<Graph> analysis(g);
+    std::vector<std::pair<int,int>> edges;
+    g.forEachEdge([&](const typename Graph::Edge& e) {
+        edges.push_back(std::make_pair(e.Either(), e.Other(e.Either())));
+    });
+
+    CompactUnionFind uf(g.V());
+    uf.UnionAll(edges);
+    bool ok = uf.Count() == analysis.Count();
+    for (int v = 0; ok && v < g.V(); ++v)
+        for (int w : { 0, v / 2, g.V() - 1 })
+            if (uf.Connected(v, w) != analysis.Connected(v, w)) ok = false;
+    if (!ok) {
+        cout << "Oops: connected components differ" << endl;
+        return false;
+    }
+    if (!bruteForce) return true;
+
+    std::vector<int> articulation;
+    for (int x = 0; x < g.V(); ++x) {
+        CompactUnionFind without(g.V());
+        std::vector<int> neighbours;
+        for (auto const & e : edges) {
+            if (e.first == x && e.second != x) neighbours.push_back(e.second);
+            else if (e.second == x && e.first != x) neighbours.push_back(e.first);
+            else if (e.first != x) without.Unite(e.first, e.second);
+        }
+        for (int w : neighbours)
+            if (!without.Connected(w, neighbours.front())) {
+                articulation.push_back(x);
+                break;
+            }
+    }
+
+    std::vector<std::pair<int,int>> bridges;
+    for (size_t i = 0; i < edges.size(); ++i) {
+        CompactUnionFind without(g.V());
+        for (size_t j = 0; j < edges.size(); ++j)
+            if (j != i) without.Unite(edges[j].first, edges[j].second);
+        if (!without.Connected(edges[i].first, edges[i].second))
+            bridges.push_back(std::minmax(edges[i].first, edges[i].second));
+    }
+
+    std::vector<std::pair<int,int>> found;
+    for (auto const & b : analysis.Bridges())
+        found.push_back(std::minmax(b.first, b.second));
+    std::sort(bridges.begin(), bridges.end());
+    std::sort(found.begin(), found.end());
+
+    if (articulation != analysis.ArticulationPoints()) {
+        cout << "Oops: articulation points differ" << endl;
+        ok = false;
+    }
+    if (bridges != found) {
+        cout << "Oops: bridges differ" << endl;
+        ok = false;
+    }
+    return ok;
+}
+
+void testGraphAnalysis(string filename)
+{
+    cout << "Testing graph analysis " << filename << endl;
+
+    typedef CSRGraph<double> Graph;
+    Graph g = EWDReader::ReadGraph<double>(filename);
+
+    Stopwatch watch;
+    GraphAnalysis<Graph> analysis(g);
+    cout << "Analysis:     " << watch.Seconds() << " seconds." << endl;
+    cout << "  " << analysis.Count() << " composantes, " << analysis.ArticulationPoints().size()
+         << " points d'articulation, " << analysis.Bridges().size() << " ponts" << endl;
+
+    // l'arbre couvrant a beaucoup de points d'articulation et toutes ses
+    // aretes sont des ponts
+    std::vector<int> from, to;
+    std::vector<double> weights;
+    for (auto const & e : MinimumSpanningTree<Graph>::Kruskal(g)) {
+        from.push_back(e.Either());
+        to.push_back(e.Other(e.Either()));
+        weights.push_back(e.Weight());
+    }
+    Graph tree(Graph::BuildStorage(g.V(), from, to, weights, true));
+
+    bool bruteForce = g.V() <= 1000;
+    bool ok = checkGraphAnalysis(g, bruteForce);
+    ok = checkGraphAnalysis(tree, bruteForce) && ok;
+    if (ok && int(GraphAnalysis<Graph>(tree).Bridges().size()) != int(from.size())) {
+        cout << "Oops: some tree edges are not bridges" << endl;
+        ok = false;
+    }
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// execute Dijkstra, Kruskal et EagerPrim avec CountingInstrumentation sur le
+// graphe defini par filename, verifie que les resultats sont ceux des versions
+// non instrumentees et que les compteurs sont coherents.
+void testInstrumentation(string filename)
+{
+    cout << "Testing instrumentation " << filename << endl;
+
+    typedef CSRDiGraph<double> DiGraph;
+    typedef CSRGraph<double> Graph;
+    typedef MinimumSpanningTree<Graph> MST;
+    DiGraph dg = EWDReader::ReadDiGraph<double>(filename);
+    Graph g = EWDReader::ReadGraph<double>(filename);
+
+    bool ok = true;
+    auto check = [&ok](bool condition, const string& message) {
+        if (!condition) {
+            cout << "Oops: " << message << endl;
+            ok = false;
+        }
+    };
+
+    DijkstraSP<DiGraph> referenceSP(dg, 0);
+    DijkstraSP<DiGraph,4,CountingInstrumentation> countedSP(dg, 0);
+    ok = compareShortestPath(referenceSP, countedSP, dg.V()) && ok;
+
+    const SearchStats& sp = countedSP.Stats();
+    long reachable = 0;
+    for (int v = 0; v < dg.V(); ++v)
+        if (countedSP.HasPathTo(v)) ++reachable;
+    cout << "  Dijkstra: " << sp.settled << " sommets fixes, " << sp.scanned << " arcs, "
+         << sp.relaxations << " relaxations, " << sp.decreaseKeys << " diminutions, queue max "
+         << sp.queuePeak << endl;
+    check(sp.settled == reachable && sp.pushes == reachable, "Dijkstra settled or pushed vertices");
+    check(sp.scanned <= dg.Entries(), "Dijkstra scanned more arcs than the graph has");
+    // la source est inseree sans relaxation
+    check(sp.relaxations + 1 == sp.pushes + sp.decreaseKeys, "Dijkstra relaxations");
+    check(sp.queuePeak >= 1 && sp.queuePeak <= dg.V(), "Dijkstra queue peak");
+
+    CountingInstrumentation kruskal;
+    MST::EdgeList tree = MST::Kruskal(g, kruskal);
+    const SearchStats& k = kruskal.Stats();
+    cout << "  Kruskal: " << k.scanned << " aretes examinees, " << k.finds << " recherches, "
+         << k.findSteps << " liens, profondeur max " << k.findDepthMax << endl;
+    check(std::abs(totalWeight(tree) - totalWeight(MST::Kruskal(g))) < 1e-9, "Kruskal weight");
+    check(k.settled == long(tree.size()) && k.finds == 2 * k.scanned, "Kruskal counters");
+    check(k.findDepthMax <= k.findSteps, "Kruskal find depth");
+
+    CountingInstrumentation prim;
+    double primWeight = totalWeight(MST::EagerPrim<4>(g, prim));
+    const SearchStats& p = prim.Stats();
+    check(std::abs(primWeight - totalWeight(tree)) < 1e-9, "EagerPrim weight");
+    check(p.settled == g.V() && p.scanned == g.Entries(), "EagerPrim counters");
+    check(p.relaxations == p.pushes + p.decreaseKeys, "EagerPrim relaxations");
+
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// genere un graphe de chaque type, verifie qu'il ne depend pas du nombre de
+// threads et qu'il survit a l'ecriture au format EWD, puis compare Dijkstra a
+// BellmanFord avec queue et Kruskal a FilterKruskal sur ce graphe.
+void testGraphGenerators(TrainNetwork& tn)
+{
+    cout << "Testing graph generators" << endl;
+
+    using namespace GraphGenerator;
+    typedef CSRDiGraph<double> DiGraph;
+    typedef CSRGraph<double> Graph;
+    typedef MinimumSpanningTree<Graph> MST;
+
+    ThreadPool single(1), pool;
+    bool ok = true;
+    auto check = [&](const string& name, const Edges& a, const Edges& b, bool directed) {
+        if (a.V != b.V || a.from != b.from || a.to != b.to || a.weight != b.weight) {
+            cout << "Oops: " << name << " depends on the number of threads" << endl;
+            ok = false;
+            return;
+        }
+        WriteEWD(a, name + ".ewd", pool);
+        EWDReader::EdgeArrays<double> read = EWDReader::ReadEdges<double>(name + ".ewd");
+        std::remove((name + ".ewd").c_str());
+        if (read.from != a.from || read.to != a.to || read.weight != a.weight) {
+            cout << "Oops: " << name << " EWD file differs" << endl;
+            ok = false;
+        }
+
+        DiGraph dg = MakeCSRDiGraph(directed ? a : Symmetrize(a));
+        Graph g = MakeCSRGraph(a);
+        DijkstraSP<DiGraph> dijkstra(dg, 0);
+        BellmanFordQueueSP<DiGraph> bellmanFord(dg, 0);
+        ok = compareShortestPath(bellmanFord, dijkstra, dg.V()) && ok;
+        double reference = totalWeight(MST::Kruskal(g)), filter = totalWeight(MST::FilterKruskal(g));
+        if (std::abs(filter - reference) > 1e-9 * std::max(1.0, reference)) {
+            cout << "Oops: " << name << " MST weight " << filter << " != " << reference << endl;
+            ok = false;
+        }
+        cout << "  " << name << ": " << a.V << " sommets, " << a.from.size() << " aretes" << endl;
+    };
+
+    Stopwatch watch;
+    check("grid", Grid(100, 150, 0.5, 1, single), Grid(100, 150, 0.5, 1, pool), false);
+    check("geometric", RandomGeometric(5000, 6, 2, single), RandomGeometric(5000, 6, 2, pool), false);
+    check("rmat", RMAT(12, 8, 3, single), RMAT(12, 8, 3, pool), true);
+    RailProfile profile = Profile(tn);
+    Edges rail = RailLike(10000, profile, 4, pool);
+    check("rail", RailLike(10000, profile, 4, single), rail, false);
+    cout << "Generators:   " << watch.Seconds() << " seconds." << endl;
+
+    Graph railGraph = MakeCSRGraph(rail);
+    if (GraphAnalysis<Graph>(railGraph).Count() != 1) {
+        cout << "Oops: rail-like network is not connected" << endl;
+        ok = false;
+    }
+    // une ville seule n'a pas de voisine
+    try {
+        RailLike(1, profile, 4, pool);
+        cout << "Oops: rail-like network with one city accepted" << endl;
+        ok = false;
+    } catch (const std::invalid_argument&) {
+    }
+    Edges twoCities = RailLike(2, profile, 4, pool);
+    if (GraphAnalysis<Graph>(MakeCSRGraph(twoCities)).Count() != 1) {
+        cout << "Oops: rail-like network of two cities is not connected" << endl;
+        ok = false;
+    }
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// traite un lot de requetes aleatoires (avec ou sans ville de passage et
+// gare fermee) avec RouteExecutor, verifie que le resultat ne depend pas du
+// nombre de threads et compare chaque itineraire a Dijkstra sur le reseau
+// prive de la gare fermee.
+void testRouteExecutor(TrainNetwork& tn)
+{
+    cout << "Testing route executor" << endl;
+
+    RouteExecutor executor(tn, "reseau.txt");
+    int C = int(tn.cities.size());
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> city(0, C - 1);
+    std::vector<RouteRequest> requests(2000);
+    for (RouteRequest& r : requests) {
+        r.depart = tn.cities[city(rng)].name;
+        r.arrivee = tn.cities[city(rng)].name;
+        if (rng() % 2) r.via = tn.cities[city(rng)].name;
+        if (rng() % 2) r.closed = tn.cities[city(rng)].name;
+        r.criterion = rng() % 2 ? RouteRequest::Duration : RouteRequest::Length;
+    }
+    requests.push_back(RouteRequest{ "Geneve", "Atlantis", "", "", RouteRequest::Length });
+
+    ThreadPool pool;
+    Stopwatch watch;
+    std::vector<RouteResult> results = executor.Run(requests, pool);
+    cout << "Batch:        " << watch.Seconds() << " seconds, " << requests.size() << " requetes." << endl;
+
+    bool ok = true;
+    ThreadPool single(1), four(4);
+    for (ThreadPool* p : { &single, &four }) {
+        std::vector<RouteResult> other = executor.Run(requests, *p);
+        for (size_t i = 0; ok && i < requests.size(); ++i)
+            if (other[i].found != results[i].found || other[i].total != results[i].total
+                || other[i].path.size() != results[i].path.size()) {
+                cout << "Oops: request " << i << " depends on the number of threads" << endl;
+                ok = false;
+            }
+    }
+
+    // graphes de reference, un par critere et gare fermee
+    std::map<std::pair<int,int>, CachedTrainDiGraphWrapper> graphs;
+    auto graph = [&](RouteRequest::Criterion criterion, int closed) -> const CachedTrainDiGraphWrapper& {
+        auto key = std::make_pair(int(criterion), closed);
+        auto it = graphs.find(key);
+        if (it == graphs.end())
+            it = graphs.emplace(key, CachedTrainDiGraphWrapper(tn, [&] (TrainNetwork::Line const & l) -> int {
+                if (l.cities.first == closed || l.cities.second == closed) return numeric_limits<int>::max();
+                return criterion == RouteRequest::Duration ? l.duration : l.length;
+            })).first;
+        return it->second;
+    };
+    auto distance = [&](const CachedTrainDiGraphWrapper& g, int s, int t, int closed) {
+        if (s == closed || t == closed) return numeric_limits<int>::max();
+        return DijkstraSP<CachedTrainDiGraphWrapper>(g, s).DistanceTo(t);
+    };
+
+    for (size_t i = 0; ok && i < requests.size(); ++i) {
+        const RouteRequest& r = requests[i];
+        const RouteResult& res = results[i];
+        if (!tn.cityIdx.count(r.arrivee)) {
+            if (res.error.empty() || res.found) {
+                cout << "Oops: unknown city accepted" << endl;
+                ok = false;
+            }
+            continue;
+        }
+        int s = tn.cityIdx.at(r.depart), t = tn.cityIdx.at(r.arrivee);
+        int closed = r.closed.empty() ? -1 : tn.cityIdx.at(r.closed);
+        const CachedTrainDiGraphWrapper& g = graph(r.criterion, closed);
+        int expected;
+        if (r.via.empty()) {
+            expected = distance(g, s, t, closed);
+        } else {
+            int v = tn.cityIdx.at(r.via);
+            int d1 = distance(g, s, v, closed), d2 = distance(g, v, t, closed);
+            expected = d1 == numeric_limits<int>::max() || d2 == numeric_limits<int>::max()
+                     ? numeric_limits<int>::max() : d1 + d2;
+        }
+
+        int total = 0, at = s;
+        bool valid = true;
+        for (auto const & e : res.path) {
+            valid = valid && e.From() == at && e.To() != closed;
+            total += e.Weight();
+            at = e.To();
+        }
+        valid = valid && at == t;
+        if (res.found != (expected != numeric_limits<int>::max())
+            || (res.found && (res.total != expected || total != expected || !valid))) {
+            cout << "Oops: request " << i << " (" << r.depart << " -> " << r.arrivee << ") gives "
+                 << res.total << " != " << expected << endl;
+            ok = false;
+        }
+    }
+
+    if(ok) cout << " ... test succeeded " << endl << endl;
+}
+
+// compare BellmanFord et BellmanFord avec queue sur un graphe pouvant avoir
+// des poids negatifs, et affiche le cycle de poids negatif s'il y en a un.
+void testNegativeWeights(string filename)
+{
+    cout << "Testing " << filename << endl;
+
+    typedef EdgeWeightedDiGraph<double> Graph;
+    Graph ewd(filename);
+
+    BellmanFordQueueSP<Graph> testSP(ewd,0);
+    ThreadPool pool;
+    ParallelBellmanFordSP<Graph> parallelSP(ewd,0,pool);
+
+    if(testSP.HasNegativeCycle() != parallelSP.HasNegativeCycle()) {
+        cout << "Oops: negative cycle detection differs" << endl;
+        return;
+    }
+
+    if(testSP.HasNegativeCycle()) {
+        // le cycle doit etre ferme, chaque arc partant de l'extremite du
+        // precedent, et de poids total negatif
+        auto cycle = testSP.NegativeCycle();
+        bool ok = true;
+        double weight = 0;
+        cout << "Negative cycle:";
+        for(size_t i = 0; i < cycle.size(); ++i) {
+            cout << " " << cycle[i];
+            weight += cycle[i].Weight();
+            if(cycle[i].To() != cycle[(i+1) % cycle.size()].From())
+                ok = false;
+        }
+        cout << " weight " << weight << endl;
+        if(!ok) cout << "Oops: negative cycle is not a closed directed cycle" << endl;
+        if(weight >= 0) {
+            cout << "Oops: negative cycle has weight " << weight << endl;
+            ok = false;
+        }
+        // les distances n'ont pas de sens: pas de chemin, et PathTo ne doit
+        // pas tourner dans le cycle
+        for(int v = 0; v < ewd.V(); ++v)
+            if(!testSP.PathTo(v).empty() || !parallelSP.PathTo(v).empty()) {
+                cout << "Oops: PathTo(" << v << ") not empty with a negative cycle" << endl;
+                ok = false;
+                break;
+            }
+        BellmanFordSP<Graph> plainSP(ewd,0);
+        for(int v = 0; v < ewd.V(); ++v)
+            plainSP.PathTo(v);
+        if(ok) cout << " ... test succeeded " << endl;
+        cout << endl;
+        return;
+    }
+
+    BellmanFordSP<Graph> referenceSP(ewd,0);
+    bool ok = compareShortestPath(referenceSP, testSP, ewd.V()) && compareShortestPath(referenceSP, parallelSP, ewd.V());
+    ok = ok && checkPathTo("BF queue", testSP, ewd.V(), 0) && checkPathTo("BF parallel", parallelSP, ewd.V(), 0)
+            && checkPathTo("Bellman-Ford", referenceSP, ewd.V(), 0);
+
+    // un sommet autre que la source a distance nulle ne doit pas couper
+    // les chemins qui passent par lui
+    Graph zero(3);
+    zero.addEdge(0, 1, 0.0);
+    zero.addEdge(1, 2, 1.0);
+    DijkstraSP<Graph> zeroSP(zero, 0);
+    if (zeroSP.PathTo(2).size() != 2) {
+        cout << "Oops: PathTo stops at a vertex of distance 0" << endl;
+        ok = false;
+    }
+    ok = ok && checkPathTo("Dijkstra", zeroSP, zero.V(), 0);
 
     if(ok) cout << " ... test succeeded " << endl << endl;
 }
@@ -173,10 +1363,52 @@ int main() {
     testShortestPath("tinyEWD.txt");
     testShortestPath("mediumEWD.txt");
     testShortestPath("1000EWD.txt");
-    //testShortestPath("10000EWD.txt");
+    testShortestPath("10000EWD.txt");
+
+    testDeltaSteppingThreads("10000EWD.txt");
+
+    testLandmarkTables("mediumEWD.txt");
+
+    testMalformedEWD();
+
+    testCorruptSnapshot("tinyEWD.txt");
+
+    testDynamicShortestPath("tinyEWD.txt");
+    testDynamicShortestPath("mediumEWD.txt");
+    testDynamicShortestPath("10000EWD.txt");
+
+    testMinimumSpanningTree("tinyEWD.txt");
+    testMinimumSpanningTree("mediumEWD.txt");
+    testMinimumSpanningTree("10000EWD.txt");
+
+    testDynamicMST("tinyEWD.txt");
+    testDynamicMST("mediumEWD.txt");
+    testDynamicMST("10000EWD.txt");
+
+    testGraphAnalysis("tinyEWD.txt");
+    testGraphAnalysis("mediumEWD.txt");
+    testGraphAnalysis("10000EWD.txt");
+
+    testInstrumentation("tinyEWD.txt");
+    testInstrumentation("10000EWD.txt");
+
+    testNegativeWeights("tinyEWDn.txt");
+    testNegativeWeights("tinyEWDnc.txt");
 
     TrainNetwork tn("reseau.txt");
 
+    testGraphGenerators(tn);
+
+    testRouteExecutor(tn);
+
+    testTrainGraphWrappers(tn);
+
+    testTrainSnapshot(tn);
+
+    testTrainNetworkAnalysis(tn);
+
+    testParetoSP(tn);
+
     cout << "1. Quelles lignes doivent etre renovees ? Quel sera le cout de la renovation de ces lignes ?" << endl;
 
     ReseauLeMoinsCher(tn);
@@ -187,7 +1419,8 @@ int main() {
 
     cout << "3. Chemin le plus court entre Geneve et Coire, avec la gare de Sion en travaux" << endl;
 
-    PlusCourtCheminAvecTravaux("Geneve", "Coire", "Sion", tn);
+    TrainNetworkAnalysis analyses(tn);
+    PlusCourtCheminAvecTravaux("Geneve", "Coire", "Sion", tn, analyses);
 
     cout << "4. Chemin le plus rapide entre Geneve et Coire en passant par Brigue" << endl;
 
@@ -197,6 +1430,10 @@ int main() {
 
     PlusRapideChemin("Lausanne", "Zurich", "Bale", tn);
 
+    cout << "6. Meilleurs compromis longueur / temps / cout entre Geneve et Coire" << endl;
+
+    CompromisChemin("Geneve", "Coire", tn);
+
     return EXIT_SUCCESS;
 }
 